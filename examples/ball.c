@@ -5,6 +5,8 @@
 #include <string.h>
 #include "lcd/lcd.h"
 #include "lcd/font.h"
+#include "lcd/ticker.h"
+#include "lcd/tween.h"
 
 #define FRAMES_PER_SECOND 30
 #define BILLION 1000000000L
@@ -45,32 +47,33 @@ Buffer image = {
 typedef struct Ball {
     int x;
     int y;
-    int vx;
-    int vy;
     int r;
 } Ball;
 
 static Ball balls[8];
+static LCD_Tweens motion;
+
+// bounces between lo and hi at speed pixels per frame, starting at *value
+void bounce(int id, int *value, int lo, int hi, int speed) {
+    int frame_ms = 1000 / FRAMES_PER_SECOND;
+    int duration = (hi - lo) * frame_ms / abs(speed);
+    int start = *value;
+    int tween = LCD_TweenAdd(&motion, id, value, lo, hi, duration, LCD_EASE_LINEAR, LCD_TWEEN_PINGPONG);
+    if (speed > 0)
+        LCD_TweenSeek(&motion, tween, (start - lo) * frame_ms / speed);
+    else
+        LCD_TweenSeek(&motion, tween, duration + (hi - start) * frame_ms / -speed);
+    *value = start;
+}
 
-void create_ball(Ball *ball) {
-    ball->vx = ((rand() % 2) * 2 - 1) * (rand() % 2 + 1);
-    ball->vy = ((rand() % 2) * 2 - 1) * (rand() % 2 + 1);
+void create_ball(int id, Ball *ball) {
+    int vx = ((rand() % 2) * 2 - 1) * (rand() % 2 + 1);
+    int vy = ((rand() % 2) * 2 - 1) * (rand() % 2 + 1);
     ball->r = rand() % 8 + 4;
     ball->x = rand() % (LCD_WIDTH - ball->r * 2) + ball->r;
     ball->y = rand() % (LCD_HEIGHT - ball->r * 2) + ball->r;
-}
-
-void update_ball(Ball *ball) {
-    ball->x += ball->vx;
-    ball->y += ball->vy;
-    if (ball->x - ball->r < 0 || ball->x + ball->r >= LCD_WIDTH) {
-        ball->vx = -ball->vx;
-        ball->x += 2 * ball->vx;
-    }
-    if (ball->y - ball->r < 0 || ball->y + ball->r >= LCD_HEIGHT) {
-        ball->vy = -ball->vy;
-        ball->y += 2 * ball->vy;
-    }
+    bounce(id, &ball->x, ball->r, LCD_WIDTH - 1 - ball->r, vx);
+    bounce(id, &ball->y, ball->r, LCD_HEIGHT - 1 - ball->r, vy);
 }
 
 void draw_ball(Ball *ball) {
@@ -84,16 +87,17 @@ int main()
     struct Timer fps;
 	
 	int size = sizeof(balls) / sizeof(*balls);
-    int i, j;
+    int i;
+    unsigned char moved[LCD_TWEEN_OBJECTS];
 
-    const char string[] = "Hello World! How are you? ";
-    int len = strlen(string);
+    static LCD_Ticker banner;
 
     srand(time(NULL));
 
+    LCD_TweenInit(&motion);
     for (i = 0; i < size; ++i)
     {
-        create_ball(&balls[i]);
+        create_ball(i, &balls[i]);
     }
 
     if (LCD_Init() != 0) {
@@ -103,16 +107,15 @@ int main()
 
     LCD_SetBacklight(1);
 
-    j = 0;
+    LCD_TickerInit(&banner, 0, (LCD_HEIGHT - LCD_CHAR_HEIGHT) / 2, LCD_WIDTH, 256, 0);
+    LCD_TickerSetText(&banner, "Hello World! How are you? ");
 
     for (;;) {
 
 		timer_start(&fps);
 
-        for (i = 0; i < size; ++i)
-        {
-            update_ball(&balls[i]);
-        }
+        // overlapping balls are XORed, so the frame is redrawn even if few moved
+        LCD_TweenUpdate(&motion, 1000 / FRAMES_PER_SECOND, moved);
 
         LCD_Clear();
 
@@ -124,12 +127,8 @@ int main()
         LCD_FillRect(0, (LCD_HEIGHT - LCD_CHAR_HEIGHT) / 2 - 2, LCD_WIDTH, (LCD_HEIGHT - LCD_CHAR_HEIGHT) / 2 + LCD_CHAR_HEIGHT + 1, BLACK);
         LCD_FillRect(0, (LCD_HEIGHT - LCD_CHAR_HEIGHT) / 2 - 1, LCD_WIDTH, (LCD_HEIGHT - LCD_CHAR_HEIGHT) / 2 + LCD_CHAR_HEIGHT, WHITE);
 
-        LCD_TextLocate(j, (LCD_HEIGHT - LCD_CHAR_HEIGHT) / 2);
-        LCD_Text(string);
-        LCD_TextLocate(j + len * 4, (LCD_HEIGHT - LCD_CHAR_HEIGHT) / 2);
-        LCD_Text(string);
-
-        j = (j - 1) % (len * 4);
+        LCD_TickerDraw(&banner, OR);
+        LCD_TickerStep(&banner);
 
         LCD_Display();
 
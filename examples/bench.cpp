@@ -0,0 +1,170 @@
+#include <cstdio>
+#include <ctime>
+#include <thread>
+#include <vector>
+#include "lcd/lcd.hpp"
+#include "lcd/frame.h"
+#include "lcd/reference.h"
+
+#define BILLION 1000000000L
+#define ITERATIONS 200000
+#define REFERENCE_ITERATIONS 2000 // the references test every pixel of the clip rectangle
+#define FRAMES 100
+#define MAX_THREADS 8
+
+static const unsigned char sprite[] = {
+	0xC0, 0xF0, 0xFC, 0xFC, 0xFE, 0xFE, 0xFF, 0xFF, 0xFF, 0xFF, 0xFE, 0xFE, 0xFC, 0xFC, 0xF0, 0xC0,
+	0x03, 0x0F, 0x3F, 0x3F, 0x7F, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F, 0x7F, 0x3F, 0x3F, 0x0F, 0x03,
+};
+
+static long long now_ns() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return BILLION * ts.tv_sec + ts.tv_nsec;
+}
+
+// times iterations calls of f(i), in nanoseconds per call
+template <typename F>
+static double measure(F f, int iterations = ITERATIONS) {
+	long long start = now_ns();
+	for (int i = 0; i < iterations; ++i) {
+		f(i);
+	}
+	return (double)(now_ns() - start) / iterations;
+}
+
+static void report(const char *name, double c, double cpp) {
+	printf("%-16s %8.1f ns %8.1f ns %6.2fx\n", name, c, cpp, c / cpp);
+}
+
+// the primitive against its reference.h counterpart
+template <typename R, typename F>
+static void compare(const char *name, R reference, F primitive) {
+	report(name, measure(reference, REFERENCE_ITERATIONS), measure(primitive, REFERENCE_ITERATIONS));
+}
+
+// virtual canvas much larger than the screen, rendered by several threads
+typedef lcd::Surface<1024, 1024> Canvas;
+static unsigned char canvas[Canvas::size];
+
+static void render_region(const Canvas &surface, int y1, int y2) {
+	surface.fill_rect<XOR>(0, y1, Canvas::width - 1, y2);
+	for (int y = y1; y <= y2; y += 3)
+		surface.hline<XOR>(y, 0, Canvas::width - 1);
+	for (int x = 0; x < Canvas::width; x += 7)
+		surface.vline<XOR>(x, y1, y2);
+	for (int y = y1; y + 16 <= y2 + 1; y += 16)
+		for (int x = 0; x + 16 <= Canvas::width; x += 16)
+			surface.blit<OR>(sprite, x, y, 16, 16);
+}
+
+static void worker(LCD_Frame *frame, int index) {
+	Canvas surface(canvas);
+	unsigned int seen = 0;
+	int x1, y1, x2, y2;
+	LCD_FrameRegion(frame, index, &x1, &y1, &x2, &y2);
+	while (LCD_FrameNext(frame, &seen, -1)) {
+		render_region(surface, y1, y2);
+		LCD_FrameSubmit(frame);
+	}
+}
+
+// milliseconds per frame
+static double measure_threads(int threads) {
+	LCD_Frame frame;
+	std::vector<std::thread> workers;
+	LCD_FrameInit(&frame, canvas, Canvas::width, Canvas::height, threads);
+	for (int i = 0; i < threads; ++i)
+		workers.emplace_back(worker, &frame, i);
+
+	long long start = now_ns();
+	for (int f = 0; f < FRAMES; ++f) {
+		LCD_FrameStart(&frame);
+		LCD_FrameWait(&frame, -1);
+	}
+	double elapsed = (double)(now_ns() - start) / FRAMES / 1000000;
+
+	LCD_FrameStop(&frame);
+	for (std::thread &t : workers)
+		t.join();
+	return elapsed;
+}
+
+int main()
+{
+	lcd::Screen screen = lcd::screen();
+
+	printf("%-16s %11s %11s %7s\n", "primitive", "C", "C++", "gain");
+
+	report("pixel",
+	       measure([](int i) { LCD_Pixel(i % LCD_WIDTH, i % LCD_HEIGHT, XOR); }),
+	       measure([&](int i) { screen.pixel<XOR>(i % LCD_WIDTH, i % LCD_HEIGHT); }));
+
+	report("horizontal line",
+	       measure([](int i) { LCD_HorizontalLine(i % LCD_HEIGHT, 3, 80, XOR); }),
+	       measure([&](int i) { screen.hline<XOR>(i % LCD_HEIGHT, 3, 80); }));
+
+	report("vertical line",
+	       measure([](int i) { LCD_VerticalLine(i % LCD_WIDTH, 3, 44, XOR); }),
+	       measure([&](int i) { screen.vline<XOR>(i % LCD_WIDTH, 3, 44); }));
+
+	report("fill rect",
+	       measure([](int i) { LCD_FillRect(i % 8, 3, 70, 44, XOR); }),
+	       measure([&](int i) { screen.fill_rect<XOR>(i % 8, 3, 70, 44); }));
+
+	report("blit",
+	       measure([](int i) { LCD_Blit(sprite, i % LCD_WIDTH - 8, i % LCD_HEIGHT - 8, 16, 16, OR); }),
+	       measure([&](int i) { screen.blit<OR>(sprite, i % LCD_WIDTH - 8, i % LCD_HEIGHT - 8, 16, 16); }));
+
+	printf("\n%-16s %11s %11s %7s\n", "kernel", "reference", "optimized", "speedup");
+
+	compare("clear",
+	        [](int) { LCD_RefClear(); },
+	        [](int) { LCD_Clear(); });
+
+	compare("line",
+	        [](int i) { LCD_RefDrawLine(i % 8 - 4, 2, 80, i % LCD_HEIGHT, XOR); },
+	        [](int i) { LCD_DrawLine(i % 8 - 4, 2, 80, i % LCD_HEIGHT, XOR); });
+
+	compare("horizontal line",
+	        [](int i) { LCD_RefHorizontalLine(i % LCD_HEIGHT, 3, 80, XOR); },
+	        [](int i) { LCD_HorizontalLine(i % LCD_HEIGHT, 3, 80, XOR); });
+
+	compare("vertical line",
+	        [](int i) { LCD_RefVerticalLine(i % LCD_WIDTH, 3, 44, XOR); },
+	        [](int i) { LCD_VerticalLine(i % LCD_WIDTH, 3, 44, XOR); });
+
+	compare("fill rect",
+	        [](int i) { LCD_RefFillRect(i % 8, 3, 70, 44, XOR); },
+	        [](int i) { LCD_FillRect(i % 8, 3, 70, 44, XOR); });
+
+	compare("draw rect",
+	        [](int i) { LCD_RefDrawRect(i % 8, 3, 70, 44, XOR); },
+	        [](int i) { LCD_DrawRect(i % 8, 3, 70, 44, XOR); });
+
+	compare("draw circle",
+	        [](int i) { LCD_RefDrawCircle(42, 24, i % 20 + 4, XOR); },
+	        [](int i) { LCD_DrawCircle(42, 24, i % 20 + 4, XOR); });
+
+	compare("fill circle",
+	        [](int i) { LCD_RefFillCircle(42, 24, i % 20 + 4, XOR); },
+	        [](int i) { LCD_FillCircle(42, 24, i % 20 + 4, XOR); });
+
+	compare("blit",
+	        [](int i) { LCD_RefBlit(sprite, i % LCD_WIDTH - 8, i % LCD_HEIGHT - 8, 16, 16, XOR); },
+	        [](int i) { LCD_Blit(sprite, i % LCD_WIDTH - 8, i % LCD_HEIGHT - 8, 16, 16, XOR); });
+
+	compare("scroll",
+	        [](int i) { LCD_RefScroll(i % 5 - 2, i % 3 - 1); },
+	        [](int i) { LCD_Scroll(i % 5 - 2, i % 3 - 1); });
+
+	printf("\n%dx%d canvas\n%-16s %11s %7s\n", Canvas::width, Canvas::height, "threads", "frame", "speedup");
+	double single = measure_threads(1);
+	printf("%-16d %8.2f ms %6.2fx\n", 1, single, 1.0);
+	for (int threads = 2; threads <= MAX_THREADS; threads *= 2) {
+		double ms = measure_threads(threads);
+		printf("%-16d %8.2f ms %6.2fx\n", threads, ms, single / ms);
+	}
+
+	return 0;
+}
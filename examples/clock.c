@@ -52,8 +52,6 @@ static const char *months[] = {
 	"December"
 };
 
-static char date_string[512];
-
 static const unsigned char numbers[] = {
 	0xF0, 0xF0, 0xFC, 0xFC, 0x03, 0x03, 0x03, 0x03, 0x0F, 0x0F, 0xFC, 0xFC, 0xF0, 0xF0, 0x00, 0x00,
 	0x03, 0x03, 0x0F, 0x0F, 0x3C, 0x3C, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F, 0x03, 0x03, 0x00, 0x00,
@@ -81,7 +79,7 @@ static const unsigned char numbers[] = {
 
 struct Banner
 {
-	char *string;
+	struct tm *date;
 	int offset;
 	int len;
 };
@@ -116,16 +114,15 @@ void draw_clock_frame() {
 
 }
 
-void string_print_date(char *string, struct tm *current) {
-	sprintf(string, "%s %d %s %d",
-	        days[current->tm_wday],
-	        current->tm_mday,
-	        months[current->tm_mon],
-	        1900 + current->tm_year);
+int text_print_date(struct tm *current) {
+	return LCD_Textf("%s %d %s %d",
+	                 days[current->tm_wday],
+	                 current->tm_mday,
+	                 months[current->tm_mon],
+	                 1900 + current->tm_year);
 }
 
 void update_banner(struct Banner *banner) {
-	banner->len = strlen(banner->string) + 1;
 	banner->offset = (banner->offset - 1) % (banner->len * (LCD_CHAR_WIDTH + 1));
 }
 
@@ -135,9 +132,9 @@ void draw_banner(struct Banner *banner, int y) {
 	LCD_HorizontalLine(y + 9, 0, LCD_WIDTH - 1, BLACK);
 
 	LCD_TextLocate(banner->offset, y + 2);
-	LCD_Text(banner->string);
+	banner->len = text_print_date(banner->date) + 1;
 	LCD_TextLocate(banner->offset + (banner->len * (LCD_CHAR_WIDTH + 1)), y + 2);
-	LCD_Text(banner->string);
+	text_print_date(banner->date);
 }
 
 int main()
@@ -147,8 +144,9 @@ int main()
 	time_t current;
 	struct tm *current_tm;
 	struct Banner date_banner = {
-		.string = date_string,
-		.offset = 0
+		.date = NULL,
+		.offset = 0,
+		.len = 1
 	};
 
 	if (LCD_Init() != 0) {
@@ -164,7 +162,7 @@ int main()
 
 		current = time(NULL);
 		current_tm = localtime(&current);
-		string_print_date(date_string, current_tm);
+		date_banner.date = current_tm;
 
 		LCD_Clear();
 		draw_clock_frame();
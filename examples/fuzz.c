@@ -0,0 +1,184 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lcd/lcd.h"
+#include "lcd/shape.h"
+#include "lcd/reference.h"
+
+// Differential fuzzing of the primitives: each case draws a random primitive
+// with random arguments, often off screen, under random clip rectangles and
+// viewports, once with the primitive and once with its reference, on the same
+// random frame. Any difference is reported with the case that caused it.
+//
+//     fuzz [cases] [seed]
+//
+// Built with LCD_LIBFUZZER (make libfuzzer), the cases are read from the
+// inputs libFuzzer generates instead.
+
+#define CASES 100000
+
+// case bytes, from the fuzzer input or from a generator once it runs out
+typedef struct {
+	const unsigned char *data;
+	size_t size, pos;
+	unsigned int state;
+} Input;
+
+static const char *names[] = {
+	"clear", "invert", "pixel", "line", "horizontal line", "vertical line",
+	"fill rect", "draw rect", "draw circle", "fill circle", "blit", "scroll",
+	"draw ellipse", "fill ellipse", "stroke ellipse", "stroke circle", "draw arc",
+	"stroke arc", "fill pie", "draw round rect", "fill round rect",
+	"stroke round rect", "stroke rect"
+};
+
+#define OPS (int)(sizeof(names) / sizeof(names[0]))
+
+static LCD_Buffer fast, slow, before;
+static unsigned char sprite[33 * 5];
+
+static unsigned int next(unsigned int *state) {
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+static int byte(Input *in) {
+	if (in->pos < in->size) return in->data[in->pos++];
+	return next(&in->state) & 0xFF;
+}
+
+// -100..155, a third of it off screen
+static int coord(Input *in) {
+	return byte(in) - 100;
+}
+
+static void draw(int op, const int *a, int reference) {
+	switch (op) {
+	case 0: reference ? LCD_RefClear() : LCD_Clear(); break;
+	case 1: reference ? LCD_RefInvert() : LCD_Invert(); break;
+	case 2: reference ? LCD_RefPixel(a[0], a[1], a[4]) : LCD_Pixel(a[0], a[1], a[4]); break;
+	case 3: reference ? LCD_RefDrawLine(a[0], a[1], a[2], a[3], a[4]) : LCD_DrawLine(a[0], a[1], a[2], a[3], a[4]); break;
+	case 4: reference ? LCD_RefHorizontalLine(a[0], a[1], a[2], a[4]) : LCD_HorizontalLine(a[0], a[1], a[2], a[4]); break;
+	case 5: reference ? LCD_RefVerticalLine(a[0], a[1], a[2], a[4]) : LCD_VerticalLine(a[0], a[1], a[2], a[4]); break;
+	case 6: reference ? LCD_RefFillRect(a[0], a[1], a[2], a[3], a[4]) : LCD_FillRect(a[0], a[1], a[2], a[3], a[4]); break;
+	case 7: reference ? LCD_RefDrawRect(a[0], a[1], a[2], a[3], a[4]) : LCD_DrawRect(a[0], a[1], a[2], a[3], a[4]); break;
+#ifndef LCD_NO_CIRCLES
+	case 8: reference ? LCD_RefDrawCircle(a[0], a[1], a[5], a[4]) : LCD_DrawCircle(a[0], a[1], a[5], a[4]); break;
+	case 9: reference ? LCD_RefFillCircle(a[0], a[1], a[5], a[4]) : LCD_FillCircle(a[0], a[1], a[5], a[4]); break;
+#endif
+	case 10: reference ? LCD_RefBlit(sprite, a[0], a[1], a[6], a[7], a[4]) : LCD_Blit(sprite, a[0], a[1], a[6], a[7], a[4]); break;
+	case 11: reference ? LCD_RefScroll(a[0], a[1]) : LCD_Scroll(a[0], a[1]); break;
+	case 12: reference ? LCD_RefDrawEllipse(a[0], a[1], a[5], a[8], a[4]) : LCD_DrawEllipse(a[0], a[1], a[5], a[8], a[4]); break;
+	case 13: reference ? LCD_RefFillEllipse(a[0], a[1], a[5], a[8], a[4]) : LCD_FillEllipse(a[0], a[1], a[5], a[8], a[4]); break;
+	case 14: reference ? LCD_RefStrokeEllipse(a[0], a[1], a[5], a[8], a[11], a[4]) : LCD_StrokeEllipse(a[0], a[1], a[5], a[8], a[11], a[4]); break;
+	case 15: reference ? LCD_RefStrokeCircle(a[0], a[1], a[5], a[11], a[4]) : LCD_StrokeCircle(a[0], a[1], a[5], a[11], a[4]); break;
+	case 16: reference ? LCD_RefDrawArc(a[0], a[1], a[5], a[8], a[9], a[10], a[4]) : LCD_DrawArc(a[0], a[1], a[5], a[8], a[9], a[10], a[4]); break;
+	case 17: reference ? LCD_RefStrokeArc(a[0], a[1], a[5], a[8], a[9], a[10], a[11], a[4]) : LCD_StrokeArc(a[0], a[1], a[5], a[8], a[9], a[10], a[11], a[4]); break;
+	case 18: reference ? LCD_RefFillPie(a[0], a[1], a[5], a[8], a[9], a[10], a[4]) : LCD_FillPie(a[0], a[1], a[5], a[8], a[9], a[10], a[4]); break;
+	case 19: reference ? LCD_RefDrawRoundRect(a[0], a[1], a[2], a[3], a[5], a[4]) : LCD_DrawRoundRect(a[0], a[1], a[2], a[3], a[5], a[4]); break;
+	case 20: reference ? LCD_RefFillRoundRect(a[0], a[1], a[2], a[3], a[5], a[4]) : LCD_FillRoundRect(a[0], a[1], a[2], a[3], a[5], a[4]); break;
+	case 21: reference ? LCD_RefStrokeRoundRect(a[0], a[1], a[2], a[3], a[5], a[11], a[4]) : LCD_StrokeRoundRect(a[0], a[1], a[2], a[3], a[5], a[11], a[4]); break;
+	case 22: reference ? LCD_RefStrokeRect(a[0], a[1], a[2], a[3], a[11], a[4]) : LCD_StrokeRect(a[0], a[1], a[2], a[3], a[11], a[4]); break;
+	default: break;
+	}
+}
+
+// Returns 1 and describes the case when the primitive and its reference
+// leave different frames.
+static int run(Input *in) {
+	int i, op, clips, clip[3][5], a[12];
+	unsigned int seed;
+
+	seed = byte(in) | byte(in) << 8 | byte(in) << 16 | (unsigned int)byte(in) << 24 | 1;
+	for (i = 0; i < (int)sizeof(before); ++i) {
+		before[i] = next(&seed) & 0xFF;
+	}
+
+	clips = byte(in) % 3;
+	for (i = 0; i < clips; ++i) {
+		clip[i][0] = byte(in) & 1;
+		clip[i][1] = coord(in);
+		clip[i][2] = coord(in);
+		clip[i][3] = coord(in);
+		clip[i][4] = coord(in);
+	}
+
+	op = byte(in) % OPS;
+	for (i = 0; i < 4; ++i) {
+		a[i] = coord(in);
+	}
+	a[4] = byte(in) % 13; // color or blit mode, invalid ones included
+	a[5] = byte(in) % 64; // radius
+	a[6] = byte(in) % 33; // blit size, with h % 8 tails
+	a[7] = byte(in) % 33;
+	a[8] = byte(in) % 64; // vertical radius
+	a[9] = (byte(in) - 128) * 3; // arc angles, past a turn both ways
+	a[10] = (byte(in) - 128) * 3;
+	a[11] = byte(in) % 8; // stroke width
+	for (i = 0; i < a[6] * ((a[7] + 7) / 8); ++i) {
+		sprite[i] = byte(in);
+	}
+
+	for (i = 0; i < clips; ++i) {
+		if (clip[i][0]) LCD_PushViewport(clip[i][1], clip[i][2], clip[i][3], clip[i][4]);
+		else LCD_PushClip(clip[i][1], clip[i][2], clip[i][3], clip[i][4]);
+	}
+	memcpy(fast, before, sizeof(before));
+	memcpy(slow, before, sizeof(before));
+	LCD_SetTarget(fast);
+	draw(op, a, 0);
+	LCD_SetTarget(slow);
+	draw(op, a, 1);
+	LCD_SetTarget(NULL);
+	for (i = 0; i < clips; ++i) {
+		LCD_PopClip();
+	}
+
+	if (!memcmp(fast, slow, sizeof(fast))) return 0;
+
+	printf("%s: %d %d %d %d, color %d, radius %d %d, size %dx%d, angles %d %d, width %d\n",
+	       names[op], a[0], a[1], a[2], a[3], a[4], a[5], a[8], a[6], a[7], a[9], a[10], a[11]);
+	for (i = 0; i < clips; ++i) {
+		printf("  in %s %d %d %d %d\n", clip[i][0] ? "viewport" : "clip",
+		       clip[i][1], clip[i][2], clip[i][3], clip[i][4]);
+	}
+	for (i = 0; i < (int)sizeof(fast); ++i) {
+		if (fast[i] != slow[i]) {
+			printf("  first difference at x %d, bank %d: %02x instead of %02x\n",
+			       i % LCD_WIDTH, i / LCD_WIDTH, fast[i], slow[i]);
+			break;
+		}
+	}
+	return 1;
+}
+
+#ifdef LCD_LIBFUZZER
+
+int LLVMFuzzerTestOneInput(const unsigned char *data, size_t size) {
+	Input in = { data, size, 0, 0x9E3779B9 };
+	if (run(&in)) abort();
+	return 0;
+}
+
+#else
+
+int main(int argc, char **argv)
+{
+	Input in = { NULL, 0, 0, 1 };
+	long i, cases = argc > 1 ? atol(argv[1]) : CASES;
+
+	if (argc > 2) in.state = strtoul(argv[2], NULL, 10) | 1;
+
+	for (i = 0; i < cases; ++i) {
+		if (run(&in)) {
+			printf("case %ld failed\n", i);
+			return 1;
+		}
+	}
+	printf("%ld cases, no difference\n", cases);
+	return 0;
+}
+
+#endif
@@ -0,0 +1,62 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include "lcd/lcd.h"
+#include "lcd/capture.h"
+
+struct Totals
+{
+	unsigned long frames;
+	unsigned long bytes;
+	unsigned long bus_us;
+	unsigned long last_us;
+};
+
+void show_frame(const unsigned char *screen, const LCD_TraceFrame *frame, void *user) {
+	struct Totals *totals = user;
+
+	// keep the pace of the original capture
+	if (frame->time_us > totals->last_us) {
+		usleep(frame->time_us - totals->last_us);
+	}
+	totals->last_us = frame->time_us;
+
+	LCD_RestoreScreen((unsigned char *)screen);
+	LCD_Display();
+
+	printf("frame %lu: %lu command bytes, %lu data bytes, %lu us on the bus\n",
+	       frame->index, frame->commands, frame->data, frame->bus_us);
+
+	totals->frames++;
+	totals->bytes += frame->commands + frame->data;
+	totals->bus_us += frame->bus_us;
+}
+
+int main(int argc, char **argv)
+{
+	struct Totals totals = { 0, 0, 0, 0 };
+	unsigned long clock_hz;
+
+	if (argc < 2) {
+		printf("usage: %s trace [clock_hz]\n", argv[0]);
+		return 1;
+	}
+	clock_hz = argc > 2 ? strtoul(argv[2], NULL, 10) : 4000000;
+
+	if (LCD_Init() != 0) {
+		printf("Error initializing LCD\n");
+		return 1;
+	}
+
+	if (LCD_Replay(argv[1], clock_hz, show_frame, &totals) != 0) {
+		printf("Error reading trace %s\n", argv[1]);
+		return 1;
+	}
+
+	if (totals.frames) {
+		printf("%lu frames, %lu bytes per frame, %lu us per frame at %lu Hz\n",
+		       totals.frames, totals.bytes / totals.frames, totals.bus_us / totals.frames, clock_hz);
+	}
+
+	return 0;
+}
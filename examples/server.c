@@ -0,0 +1,45 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <signal.h>
+#include "lcd/lcd.h"
+#include "lcd/server.h"
+
+static volatile sig_atomic_t running = 1;
+
+void stop(int signal) {
+	(void)signal;
+	running = 0;
+}
+
+int main(int argc, char **argv)
+{
+	LCD_Server *server;
+
+	if (LCD_Init() != 0) {
+		printf("Error initializing LCD\n");
+		return 1;
+	}
+
+	server = LCD_ServerOpen(argc > 1 ? argv[1] : LCD_SERVER_NAME);
+	if (server == NULL) {
+		printf("Error creating shared memory\n");
+		return 1;
+	}
+
+	signal(SIGINT, stop);
+	signal(SIGTERM, stop);
+
+	LCD_SetBacklight(1);
+	LCD_Clear();
+	LCD_Display();
+
+	while (running) {
+		if (LCD_ServerWait(server, 1000)) {
+			LCD_ServerComposite(server);
+		}
+	}
+
+	LCD_ServerClose(server);
+
+	return 0;
+}
@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "capture.h"
+#include "pcd8544.h"
+
+#define TRACE_MAGIC "LCDT"
+#define TRACE_VERSION 1
+#define MAX_RUN 64
+
+#define RECORD_COMMAND 0
+#define RECORD_DATA 1
+#define RECORD_END 2
+
+static FILE *trace = NULL;
+static unsigned long long trace_last_us;
+
+// run of bytes of the same type waiting to be written
+static int run_type = -1;
+static int run_length = 0;
+static unsigned long long run_time;
+static unsigned char run[MAX_RUN];
+
+static unsigned long long now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static void write_varint(unsigned long long value) {
+    do {
+        fputc((value & 0x7F) | (value > 0x7F ? 0x80 : 0), trace);
+        value >>= 7;
+    } while (value);
+}
+
+static void write_record(int type, unsigned long long time, const unsigned char *bytes, int length) {
+    fputc(type << 6 | (length ? length - 1 : 0), trace);
+    write_varint(time - trace_last_us);
+    trace_last_us = time;
+    if (length) fwrite(bytes, 1, length, trace);
+}
+
+static void flush_run() {
+    if (run_length) write_record(run_type, run_time, run, run_length);
+    run_length = 0;
+    run_type = -1;
+}
+
+static void capture_byte(LCD_BUS type, unsigned char byte) {
+    if (!trace) return;
+    if (type == LCD_BUS_END) {
+        flush_run();
+        write_record(RECORD_END, now_us(), NULL, 0);
+        return;
+    }
+    if ((int)type != run_type || run_length == MAX_RUN) {
+        flush_run();
+        run_type = type;
+        run_time = now_us();
+    }
+    run[run_length++] = byte;
+}
+
+int LCD_CaptureStart(const char *path) {
+    LCD_CaptureStop();
+    trace = fopen(path, "wb");
+    if (!trace) return 1;
+    fwrite(TRACE_MAGIC, 1, 4, trace);
+    fputc(TRACE_VERSION, trace);
+    trace_last_us = now_us();
+    LCD_SetBusHook(capture_byte);
+    return 0;
+}
+
+void LCD_CaptureStop() {
+    if (!trace) return;
+    LCD_SetBusHook(NULL);
+    flush_run();
+    fclose(trace);
+    trace = NULL;
+}
+
+static int read_varint(FILE *file, unsigned long long *value) {
+    int c, shift = 0;
+    *value = 0;
+    do {
+        if ((c = fgetc(file)) == EOF || shift > 63) return 1;
+        *value |= (unsigned long long)(c & 0x7F) << shift;
+        shift += 7;
+    } while (c & 0x80);
+    return 0;
+}
+
+int LCD_Replay(const char *path, unsigned long clock_hz, LCD_ReplayCallback callback, void *user) {
+    FILE *file;
+    LCD_PCD8544 lcd;
+    LCD_TraceFrame frame;
+    unsigned char header[5];
+    unsigned long long delta, time = 0;
+    int c, i, type, length;
+
+    file = fopen(path, "rb");
+    if (!file) return 1;
+    if (fread(header, 1, 5, file) != 5 || memcmp(header, TRACE_MAGIC, 4) || header[4] != TRACE_VERSION) {
+        fclose(file);
+        return 1;
+    }
+
+    LCD_PCD8544Reset(&lcd, clock_hz);
+    memset(&frame, 0, sizeof(frame));
+    while ((c = fgetc(file)) != EOF) {
+        type = c >> 6;
+        length = (c & 0x3F) + 1;
+        if (read_varint(file, &delta)) break;
+        time += delta;
+        if (type == RECORD_END) {
+            LCD_PCD8544Write(&lcd, LCD_BUS_END, 0);
+            frame.time_us = time;
+            frame.bus_us = frame.commands + frame.data ? (unsigned long)(lcd.transfer_ns / 1000) : 0;
+            if (callback) callback(lcd.ram, &frame, user);
+            ++frame.index;
+            frame.commands = frame.data = 0;
+            continue;
+        }
+        for (i = 0; i < length; ++i) {
+            if ((c = fgetc(file)) == EOF) break;
+            LCD_PCD8544Write(&lcd, type == RECORD_COMMAND ? LCD_BUS_COMMAND : LCD_BUS_DATA, c);
+            if (type == RECORD_COMMAND) ++frame.commands;
+            else ++frame.data;
+        }
+    }
+
+    fclose(file);
+    return 0;
+}
@@ -0,0 +1,32 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include "lcd.h"
+
+// Capture of the command/data byte stream sent to the controller, and replay
+// of such traces to rebuild the frames the panel would have shown.
+//
+// Trace format: "LCDT" followed by a version byte, then records made of a tag
+// byte, the time elapsed since the previous record in microseconds (LEB128)
+// and, for byte runs, the bytes themselves. Tag bits 7-6 are the record type
+// (0 command run, 1 data run, 2 end of transmission), bits 5-0 the run length
+// minus one.
+
+int LCD_CaptureStart(const char *path);
+void LCD_CaptureStop();
+
+// a frame is everything sent between two ends of transmission
+typedef struct {
+    unsigned long index;
+    unsigned long time_us; // end of the frame, since the start of the trace
+    unsigned long commands; // command bytes in the frame
+    unsigned long data; // data bytes in the frame
+    unsigned long bus_us; // estimated transfer time at the replay clock rate
+} LCD_TraceFrame;
+
+// screen is the display RAM as rebuilt from the trace, in LCD_Buffer layout
+typedef void (*LCD_ReplayCallback)(const unsigned char *screen, const LCD_TraceFrame *frame, void *user);
+
+int LCD_Replay(const char *path, unsigned long clock_hz, LCD_ReplayCallback callback, void *user);
+
+#endif
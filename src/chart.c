@@ -0,0 +1,203 @@
+#include <string.h>
+#include "chart.h"
+
+#define WIDTH(chart) ((chart)->x2 - (chart)->x1 + 1)
+
+static int map(const LCD_Chart *chart, int value) {
+    int y;
+    if (chart->hi == chart->lo) return (chart->y1 + chart->y2) / 2;
+    y = chart->y2 - (int)((long)(value - chart->lo) * (chart->y2 - chart->y1) / (chart->hi - chart->lo));
+    return y < chart->y1 ? chart->y1 : (y > chart->y2 ? chart->y2 : y);
+}
+
+static int ring_index(const LCD_Chart *chart, int age) {
+    return (chart->head - 1 - age + 2 * LCD_CHART_RING) % LCD_CHART_RING;
+}
+
+// draws the column of the given age (0 being the newest)
+static void draw_column(LCD_Chart *chart, int age) {
+    const LCD_ChartColumn *column, *previous;
+    int t, x = chart->x2 - age, top, bottom, y;
+    for (t = 0; t < chart->traces; ++t) {
+        column = &chart->columns[t][ring_index(chart, age)];
+        top = map(chart, column->max);
+        bottom = map(chart, column->min);
+        // join the previous column
+        if (age + 1 < chart->count) {
+            previous = &chart->columns[t][ring_index(chart, age + 1)];
+            y = map(chart, previous->last);
+            if (y < top) top = y;
+            if (y > bottom) bottom = y;
+        }
+        LCD_VerticalLine(x, top, bottom, BLACK);
+    }
+}
+
+// Moves the viewport content n columns to the left in place, clearing on the
+// right, within the clip rectangle like LCD_Scroll would.
+static void shift(LCD_Chart *chart, int n) {
+    unsigned char *buffer = LCD_GetTarget(), *row, mask;
+    int b, x, x1, y1, x2, y2, ox, oy;
+
+    LCD_GetClip(&x1, &y1, &x2, &y2);
+    LCD_GetOrigin(&ox, &oy);
+    if (x1 < chart->x1) x1 = chart->x1;
+    if (y1 < chart->y1) y1 = chart->y1;
+    if (x2 > chart->x2) x2 = chart->x2;
+    if (y2 > chart->y2) y2 = chart->y2;
+    if (x1 > x2 || y1 > y2) return;
+
+    // in target coordinates from now on
+    x1 += ox;
+    x2 += ox;
+    y1 += oy;
+    y2 += oy;
+    if (n > x2 - x1 + 1) n = x2 - x1 + 1;
+    for (b = y1 / 8; b <= y2 / 8; ++b) {
+        mask = 0xFF;
+        if (y1 > b * 8) mask &= 0xFF << (y1 - b * 8);
+        if (y2 < b * 8 + 7) mask &= 0xFF >> (b * 8 + 7 - y2);
+        row = buffer + b * LCD_WIDTH;
+        if (mask == 0xFF) {
+            memmove(row + x1, row + x1 + n, x2 - x1 + 1 - n);
+            memset(row + x2 - n + 1, 0, n);
+            continue;
+        }
+        for (x = x1; x <= x2 - n; ++x) {
+            row[x] = (row[x] & ~mask) | (row[x + n] & mask);
+        }
+        for (; x <= x2; ++x) {
+            row[x] &= ~mask;
+        }
+    }
+}
+
+// fits the value range on the stored columns, with a quarter of headroom
+static void fit(LCD_Chart *chart) {
+    int t, i, lo, hi, margin;
+    if (!chart->count) return;
+    lo = hi = chart->columns[0][ring_index(chart, 0)].min;
+    for (t = 0; t < chart->traces; ++t) {
+        for (i = 0; i < chart->count && i < WIDTH(chart); ++i) {
+            const LCD_ChartColumn *column = &chart->columns[t][ring_index(chart, i)];
+            if (column->min < lo) lo = column->min;
+            if (column->max > hi) hi = column->max;
+        }
+    }
+    margin = (hi - lo) / 8 + 1;
+    chart->lo = lo - margin;
+    chart->hi = hi + margin;
+    chart->since_fit = 0;
+    chart->rescale = 1;
+}
+
+void LCD_ChartInit(LCD_Chart *chart, int x1, int y1, int x2, int y2, int traces, int decimation) {
+    int t;
+    memset(chart, 0, sizeof(LCD_Chart));
+    if (x1 > x2) {
+        t = x1;
+        x1 = x2;
+        x2 = t;
+    }
+    if (y1 > y2) {
+        t = y1;
+        y1 = y2;
+        y2 = t;
+    }
+    chart->x1 = x1 < 0 ? 0 : x1;
+    chart->y1 = y1 < 0 ? 0 : y1;
+    chart->x2 = x2 >= LCD_WIDTH ? LCD_WIDTH - 1 : x2;
+    chart->y2 = y2 >= LCD_HEIGHT ? LCD_HEIGHT - 1 : y2;
+    chart->traces = traces < 1 ? 1 : (traces > LCD_CHART_TRACES ? LCD_CHART_TRACES : traces);
+    chart->decimation = decimation < 1 ? 1 : decimation;
+    chart->autoscale = 1;
+    chart->rescale = 1;
+}
+
+void LCD_ChartRange(LCD_Chart *chart, int lo, int hi) {
+    chart->autoscale = 0;
+    chart->lo = lo < hi ? lo : hi;
+    chart->hi = lo < hi ? hi : lo;
+    chart->rescale = 1;
+}
+
+void LCD_ChartAutoscale(LCD_Chart *chart) {
+    chart->autoscale = 1;
+    fit(chart);
+}
+
+// one value per trace
+void LCD_ChartPush(LCD_Chart *chart, const int *values) {
+    int t, width = WIDTH(chart);
+    LCD_ChartColumn *current;
+
+    for (t = 0; t < chart->traces; ++t) {
+        current = &chart->current[t];
+        if (!chart->samples || values[t] < current->min) current->min = values[t];
+        if (!chart->samples || values[t] > current->max) current->max = values[t];
+        current->last = values[t];
+    }
+    if (++chart->samples < chart->decimation) return;
+
+    // column complete
+    for (t = 0; t < chart->traces; ++t) {
+        chart->columns[t][chart->head] = chart->current[t];
+    }
+    chart->head = (chart->head + 1) % LCD_CHART_RING;
+    chart->samples = 0;
+    if (chart->count <= width) ++chart->count;
+    if (chart->pending < width) ++chart->pending;
+    ++chart->since_fit;
+
+    if (!chart->autoscale) return;
+    // grow at once when a value leaves the range, shrink lazily once a whole
+    // viewport has scrolled by
+    for (t = 0; t < chart->traces; ++t) {
+        if (chart->current[t].min < chart->lo || chart->current[t].max > chart->hi || chart->count == 1) {
+            fit(chart);
+            return;
+        }
+    }
+    if (chart->since_fit >= width) {
+        int lo = chart->lo, hi = chart->hi, rescale = chart->rescale;
+        fit(chart);
+        // keep the old range, and the cheap path, if it still fits well
+        if ((chart->hi - chart->lo) * 2 > hi - lo) {
+            chart->lo = lo;
+            chart->hi = hi;
+            chart->rescale = rescale;
+        }
+    }
+}
+
+void LCD_ChartRender(LCD_Chart *chart) {
+    int age;
+    if (!chart->pending && !chart->rescale) return;
+
+    if (chart->rescale || chart->pending >= WIDTH(chart)) {
+        LCD_FillRect(chart->x1, chart->y1, chart->x2, chart->y2, WHITE);
+        for (age = 0; age < chart->count && age < WIDTH(chart); ++age) {
+            draw_column(chart, age);
+        }
+    }
+    else {
+        shift(chart, chart->pending);
+        for (age = 0; age < chart->pending; ++age) {
+            draw_column(chart, age);
+        }
+    }
+    chart->pending = 0;
+    chart->rescale = 0;
+    chart->dirty = 1;
+}
+
+// sends the viewport to the screen if it changed
+void LCD_ChartDisplay(LCD_Chart *chart) {
+    int b, ox, oy;
+    if (!chart->dirty) return;
+    LCD_GetOrigin(&ox, &oy);
+    for (b = (chart->y1 + oy) / 8; b <= (chart->y2 + oy) / 8; ++b) {
+        LCD_DisplaySpan(b, chart->x1 + ox, chart->x2 + ox);
+    }
+    chart->dirty = 0;
+}
@@ -0,0 +1,49 @@
+#ifndef CHART_H
+#define CHART_H
+
+#include "lcd.h"
+
+// Rolling strip chart. Samples are folded into columns (min, max and last value
+// of every trace); completed columns are kept in a ring buffer as wide as the
+// viewport. Rendering shifts the viewport left in place and only draws the new
+// columns, unless the scale changed. The viewport is in drawing coordinates,
+// under the clip rectangle and origin of the calling thread; the shift writes
+// to LCD_GetTarget() directly, which must be a whole screen target.
+
+#define LCD_CHART_TRACES 4
+
+// one more column than the widest viewport, to join the oldest visible one
+#define LCD_CHART_RING (LCD_WIDTH + 1)
+
+typedef struct {
+    int min, max, last;
+} LCD_ChartColumn;
+
+typedef struct {
+    int x1, y1, x2, y2; // viewport
+    int traces;
+    int decimation; // samples per column
+    int autoscale;
+    int lo, hi; // value range mapped on the viewport height
+
+    LCD_ChartColumn columns[LCD_CHART_TRACES][LCD_CHART_RING];
+    int head; // ring index of the next completed column
+    int count; // completed columns in the ring, up to the viewport width + 1
+    int pending; // completed columns not rendered yet
+    int since_fit; // columns since the range was last fitted
+
+    LCD_ChartColumn current[LCD_CHART_TRACES];
+    int samples; // samples folded in the current column
+
+    int rescale; // next render redraws everything
+    int dirty; // viewport changed since LCD_ChartDisplay
+} LCD_Chart;
+
+void LCD_ChartInit(LCD_Chart *chart, int x1, int y1, int x2, int y2, int traces, int decimation);
+void LCD_ChartRange(LCD_Chart *chart, int lo, int hi);
+void LCD_ChartAutoscale(LCD_Chart *chart);
+void LCD_ChartPush(LCD_Chart *chart, const int *values);
+void LCD_ChartRender(LCD_Chart *chart);
+void LCD_ChartDisplay(LCD_Chart *chart);
+
+#endif
@@ -0,0 +1,119 @@
+#include "collide.h"
+
+typedef unsigned long long Column;
+
+// column x of a mask as a word, row 0 in bit 0
+static Column load(const unsigned char *mask, int w, int h, int x) {
+    Column column = 0;
+    int b;
+    for (b = 0; b * 8 < h; ++b) {
+        column |= (Column)mask[x + b * w] << (b * 8);
+    }
+    if (h < 64) column &= ((Column)1 << h) - 1;
+    return column;
+}
+
+static int overlap(int a1, int a2, int b1, int b2, int *lo, int *hi) {
+    *lo = a1 > b1 ? a1 : b1;
+    *hi = a2 < b2 ? a2 : b2;
+    return *lo <= *hi;
+}
+
+int LCD_MaskCollide(const unsigned char *a, int aw, int ah, int ax, int ay,
+                    const unsigned char *b, int bw, int bh, int bx, int by) {
+    int x1, x2, y1, y2, x, dy = ay - by;
+    Column ca, cb;
+
+    if (ah > LCD_MASK_MAX_HEIGHT || bh > LCD_MASK_MAX_HEIGHT) return 0;
+    if (!overlap(ax, ax + aw - 1, bx, bx + bw - 1, &x1, &x2)) return 0;
+    if (!overlap(ay, ay + ah - 1, by, by + bh - 1, &y1, &y2)) return 0;
+
+    for (x = x1; x <= x2; ++x) {
+        ca = load(a, aw, ah, x - ax);
+        cb = load(b, bw, bh, x - bx);
+        // bring both columns to the origin of the upper one
+        if (dy >= 0 ? (ca << dy) & cb : ca & (cb << -dy)) return 1;
+    }
+    return 0;
+}
+
+int LCD_SpriteCollide(const LCD_Sprite *a, const LCD_Sprite *b) {
+    return LCD_MaskCollide(a->mask, a->w, a->h, a->x, a->y, b->mask, b->w, b->h, b->x, b->y);
+}
+
+int LCD_MaskCollideScreen(const unsigned char *mask, int w, int h, int x, int y) {
+    int ox, oy;
+    LCD_GetOrigin(&ox, &oy);
+    return LCD_MaskCollide(mask, w, h, x + ox, y + oy, LCD_GetTarget(), LCD_WIDTH, LCD_HEIGHT, 0, 0);
+}
+
+static int floor_div(int a, int b) {
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+int LCD_CollideAllGrid(const LCD_Sprite *sprites, int n, LCD_CollisionCallback callback, void *user,
+                       LCD_CollideGrid *grid) {
+    short *cell_head = grid->cell_head, *entry_next = grid->entry_next, *entry_sprite = grid->entry_sprite;
+    int i, j, e, f, cx, cy, cx1, cy1, cx2, cy2, size, entries = 0, pairs = 0;
+    int minx, miny, maxx, maxy, ix, iy, ix2, iy2;
+
+    if (n > LCD_COLLIDE_MAX_SPRITES) n = LCD_COLLIDE_MAX_SPRITES;
+    if (n < 2) return 0;
+
+    // cells at least as large as any sprite, so a sprite spans 4 cells at most
+    minx = miny = 1 << 30;
+    maxx = maxy = -(1 << 30);
+    size = 1;
+    for (i = 0; i < n; ++i) {
+        if (sprites[i].x < minx) minx = sprites[i].x;
+        if (sprites[i].y < miny) miny = sprites[i].y;
+        if (sprites[i].x + sprites[i].w > maxx) maxx = sprites[i].x + sprites[i].w;
+        if (sprites[i].y + sprites[i].h > maxy) maxy = sprites[i].y + sprites[i].h;
+        if (sprites[i].w > size) size = sprites[i].w;
+        if (sprites[i].h > size) size = sprites[i].h;
+    }
+    while ((maxx - minx) / size >= LCD_COLLIDE_GRID || (maxy - miny) / size >= LCD_COLLIDE_GRID) size *= 2;
+
+    for (i = 0; i < LCD_COLLIDE_GRID * LCD_COLLIDE_GRID; ++i) cell_head[i] = -1;
+    for (i = 0; i < n; ++i) {
+        if (sprites[i].w <= 0 || sprites[i].h <= 0) continue;
+        cx1 = (sprites[i].x - minx) / size;
+        cy1 = (sprites[i].y - miny) / size;
+        cx2 = (sprites[i].x + sprites[i].w - 1 - minx) / size;
+        cy2 = (sprites[i].y + sprites[i].h - 1 - miny) / size;
+        for (cy = cy1; cy <= cy2; ++cy) {
+            for (cx = cx1; cx <= cx2; ++cx) {
+                entry_sprite[entries] = i;
+                entry_next[entries] = cell_head[cy * LCD_COLLIDE_GRID + cx];
+                cell_head[cy * LCD_COLLIDE_GRID + cx] = entries++;
+            }
+        }
+    }
+
+    for (cy = 0; cy < LCD_COLLIDE_GRID; ++cy) {
+        for (cx = 0; cx < LCD_COLLIDE_GRID; ++cx) {
+            for (e = cell_head[cy * LCD_COLLIDE_GRID + cx]; e >= 0; e = entry_next[e]) {
+                for (f = entry_next[e]; f >= 0; f = entry_next[f]) {
+                    i = entry_sprite[e];
+                    j = entry_sprite[f];
+                    // a pair sharing several cells is only tested in the cell
+                    // holding the top left corner of their intersection
+                    if (!overlap(sprites[i].x, sprites[i].x + sprites[i].w - 1,
+                                 sprites[j].x, sprites[j].x + sprites[j].w - 1, &ix, &ix2)) continue;
+                    if (!overlap(sprites[i].y, sprites[i].y + sprites[i].h - 1,
+                                 sprites[j].y, sprites[j].y + sprites[j].h - 1, &iy, &iy2)) continue;
+                    if (floor_div(ix - minx, size) != cx || floor_div(iy - miny, size) != cy) continue;
+                    if (!LCD_SpriteCollide(&sprites[i], &sprites[j])) continue;
+                    ++pairs;
+                    if (callback) callback(i < j ? i : j, i < j ? j : i, user);
+                }
+            }
+        }
+    }
+    return pairs;
+}
+
+int LCD_CollideAll(const LCD_Sprite *sprites, int n, LCD_CollisionCallback callback, void *user) {
+    LCD_CollideGrid grid;
+    return LCD_CollideAllGrid(sprites, n, callback, user, &grid);
+}
@@ -0,0 +1,44 @@
+#ifndef COLLIDE_H
+#define COLLIDE_H
+
+#include "lcd.h"
+
+// Pixel-perfect collision of masks in LCD_Buffer layout (w bytes per bank row).
+// Each mask column is loaded as a 64 bit word, so overlapping columns are
+// tested with a single shift and AND. Masks are at most 64 pixels tall.
+
+#define LCD_MASK_MAX_HEIGHT 64
+#define LCD_COLLIDE_MAX_SPRITES 256
+#define LCD_COLLIDE_GRID 16 // broad phase grid, at most 16 x 16 cells
+
+typedef struct {
+    const unsigned char *mask;
+    int w, h;
+    int x, y;
+} LCD_Sprite;
+
+typedef void (*LCD_CollisionCallback)(int a, int b, void *user);
+
+// broad phase workspace, a sprite is listed in 4 cells at most
+typedef struct {
+    short cell_head[LCD_COLLIDE_GRID * LCD_COLLIDE_GRID];
+    short entry_next[4 * LCD_COLLIDE_MAX_SPRITES];
+    short entry_sprite[4 * LCD_COLLIDE_MAX_SPRITES];
+} LCD_CollideGrid;
+
+int LCD_MaskCollide(const unsigned char *a, int aw, int ah, int ax, int ay,
+                    const unsigned char *b, int bw, int bh, int bx, int by);
+int LCD_SpriteCollide(const LCD_Sprite *a, const LCD_Sprite *b);
+
+// tests a mask, placed as LCD_Blit would draw it, against the pixels already
+// drawn on the drawing target
+int LCD_MaskCollideScreen(const unsigned char *mask, int w, int h, int x, int y);
+
+// Reports every colliding pair of sprites once, returns the number of pairs.
+// The grid is kept on the stack; LCD_CollideAllGrid takes it from the caller
+// instead, for small stacks.
+int LCD_CollideAll(const LCD_Sprite *sprites, int n, LCD_CollisionCallback callback, void *user);
+int LCD_CollideAllGrid(const LCD_Sprite *sprites, int n, LCD_CollisionCallback callback, void *user,
+                       LCD_CollideGrid *grid);
+
+#endif
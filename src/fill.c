@@ -0,0 +1,120 @@
+#include "fill.h"
+
+typedef unsigned long long Column; // the screen is at most 64 pixels tall
+
+typedef struct {
+    unsigned char *buffer;
+    int x1, x2; // clip columns, in target coordinates
+    Column rows; // clip rows
+    int seed; // color of the region, 0 or 1
+    LCD_FillSpan *stack;
+    int capacity, count, overflow;
+} Fill;
+
+// rows y1..y2
+static Column range(int y1, int y2) {
+    return (~(Column)0 >> (63 - y2)) & (~(Column)0 << y1);
+}
+
+// pixels of column x that belong to the region, row 0 in bit 0
+static Column load(const Fill *f, int x) {
+    Column column = 0;
+    int b;
+    for (b = 0; b < LCD_HEIGHT / 8; ++b) {
+        column |= (Column)f->buffer[x + b * LCD_WIDTH] << (b * 8);
+    }
+    return (f->seed ? column : ~column) & f->rows;
+}
+
+// Flipping the pixels of a span gives them the other color, which both paints
+// them and takes them out of the region.
+static void flip(const Fill *f, int x, int y1, int y2) {
+    Column bits = range(y1, y2);
+    int b;
+    for (b = y1 / 8; b <= y2 / 8; ++b) {
+        f->buffer[x + b * LCD_WIDTH] ^= (unsigned char)(bits >> (b * 8));
+    }
+}
+
+// bounds of the run of set bits of region around row y
+static void extent(Column region, int y, int *y1, int *y2) {
+    Column above = ~region & ((((Column)1) << y) - 1);
+    Column below = ~region & (~(Column)0 << y);
+    *y1 = above ? 64 - __builtin_clzll(above) : 0;
+    *y2 = below ? __builtin_ctzll(below) - 1 : 63;
+}
+
+static void push(Fill *f, int x, int y1, int y2, int dir) {
+    LCD_FillSpan *span;
+    if (x < f->x1 || x > f->x2 || !(load(f, x) & range(y1, y2))) return;
+    if (f->count == f->capacity) {
+        f->overflow = 1;
+        return;
+    }
+    span = &f->stack[f->count++];
+    span->x = (unsigned char)x;
+    span->y1 = (unsigned char)y1;
+    span->y2 = (unsigned char)y2;
+    span->dir = (signed char)dir;
+}
+
+// Fills every run of the region that meets rows y1..y2 of column x. Runs go
+// on in the direction of the fill, and back where they stick out of the
+// span they were reached from.
+static void scan(Fill *f, const LCD_FillSpan *span) {
+    Column region = load(f, span->x);
+    Column seeds = region & range(span->y1, span->y2);
+    int x = span->x, dir = span->dir, y1, y2;
+
+    while (seeds) {
+        extent(region, __builtin_ctzll(seeds), &y1, &y2);
+        flip(f, x, y1, y2);
+        push(f, x + dir, y1, y2, dir);
+        if (y1 < span->y1) push(f, x - dir, y1, span->y1 - 1, -dir);
+        if (y2 > span->y2) push(f, x - dir, span->y2 + 1, y2, -dir);
+        seeds &= ~range(y1, y2);
+    }
+}
+
+int LCD_FloodFillStack(int x, int y, LCD_COLOR color, LCD_FillSpan *stack, int capacity) {
+    Fill f;
+    LCD_FillSpan span;
+    int cx1, cy1, cx2, cy2, ox, oy, y1, y2;
+    Column region;
+
+    if (color != WHITE && color != BLACK && color != XOR) return 0;
+    LCD_GetClip(&cx1, &cy1, &cx2, &cy2);
+    if (x < cx1 || x > cx2 || y < cy1 || y > cy2) return 0;
+    LCD_GetOrigin(&ox, &oy);
+    x += ox;
+    y += oy;
+
+    f.buffer = LCD_GetTarget();
+    f.x1 = cx1 + ox;
+    f.x2 = cx2 + ox;
+    f.rows = range(cy1 + oy, cy2 + oy);
+    f.seed = (f.buffer[x + (y / 8) * LCD_WIDTH] >> (y % 8)) & 1;
+    f.stack = stack;
+    f.capacity = capacity;
+    f.count = 0;
+    f.overflow = 0;
+    if (color != XOR && (int)color == f.seed) return 0;
+
+    // the seed span goes on both ways
+    region = load(&f, x);
+    extent(region, y, &y1, &y2);
+    flip(&f, x, y1, y2);
+    push(&f, x + 1, y1, y2, 1);
+    push(&f, x - 1, y1, y2, -1);
+
+    while (f.count) {
+        span = f.stack[--f.count];
+        scan(&f, &span);
+    }
+    return f.overflow;
+}
+
+int LCD_FloodFill(int x, int y, LCD_COLOR color) {
+    LCD_FillSpan stack[LCD_FILL_STACK];
+    return LCD_FloodFillStack(x, y, color, stack, LCD_FILL_STACK);
+}
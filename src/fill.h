@@ -0,0 +1,25 @@
+#ifndef FILL_H
+#define FILL_H
+
+#include "lcd.h"
+
+// Flood fill of the 4-connected region of same colored pixels around a seed.
+// The fill works on vertical spans, which are bit runs of a screen column: a
+// column is loaded as a 64 bit word and the ends of a span are found with a
+// single bit scan. Spans left to visit are kept on an explicit stack of fixed
+// capacity, so large regions cost no recursion.
+
+#define LCD_FILL_STACK 256 // spans, for LCD_FloodFill
+
+typedef struct {
+    unsigned char x, y1, y2;
+    signed char dir; // column the span was reached from, x - dir
+} LCD_FillSpan;
+
+// Fills with BLACK or WHITE, or inverts the region with XOR. The fill stays in
+// the clip rectangle. Returns 1 when the stack overflowed, leaving part of the
+// region unfilled, 0 otherwise.
+int LCD_FloodFill(int x, int y, LCD_COLOR color);
+int LCD_FloodFillStack(int x, int y, LCD_COLOR color, LCD_FillSpan *stack, int capacity);
+
+#endif
@@ -1,13 +1,123 @@
 #include "font.h"
 
+#ifndef LCD_NO_TEXT
+
+// text cursor and mode, per thread
+static LCD_THREAD_LOCAL int LCD_text_X = 0;
+static LCD_THREAD_LOCAL int LCD_text_Y = 0;
+static LCD_THREAD_LOCAL LCD_COLOR LCD_text_mode = OR;
+
+// pico8 style font
+const unsigned char LCD_font[96][3] = {
+	{0x00, 0x00, 0x00}, // 20
+	{0x00, 0x17, 0x00}, // 21 !
+	{0x03, 0x00, 0x03}, // 22 "
+	{0x1F, 0x0A, 0x1F}, // 23 #
+	{0x16, 0x1F, 0x0D}, // 24 $
+	{0x19, 0x04, 0x13}, // 25 %
+	{0x0A, 0x15, 0x0A}, // 26 &
+	{0x02, 0x01, 0x00}, // 27 '
+	{0x0E, 0x11, 0x00}, // 28 (
+	{0x00, 0x11, 0x0E}, // 29 )
+	{0x15, 0x0E, 0x15}, // 2a *
+	{0x04, 0x0E, 0x04}, // 2b +
+	{0x10, 0x08, 0x00}, // 2c ,
+	{0x04, 0x04, 0x04}, // 2d -
+	{0x00, 0x10, 0x00}, // 2e .
+	{0x10, 0x0E, 0x01}, // 2f /
+	{0x1F, 0x11, 0x1F}, // 30 0
+	{0x11, 0x1F, 0x10}, // 31 1
+	{0x1D, 0x15, 0x17}, // 32 2
+	{0x11, 0x15, 0x1F}, // 33 3
+	{0x07, 0x04, 0x1F}, // 34 4
+	{0x17, 0x15, 0x1D}, // 35 5
+	{0x1F, 0x14, 0x1C}, // 36 6
+	{0x01, 0x01, 0x1F}, // 37 7
+	{0x1F, 0x15, 0x1F}, // 38 8
+	{0x07, 0x05, 0x1F}, // 39 9
+	{0x00, 0x0A, 0x00}, // 3a :
+	{0x10, 0x0A, 0x00}, // 3b ;
+	{0x04, 0x0A, 0x11}, // 3c <
+	{0x0A, 0x0A, 0x0A}, // 3d =
+	{0x11, 0x0A, 0x04}, // 3e >
+	{0x01, 0x15, 0x07}, // 3f ?
+	{0x1F, 0x17, 0x17}, // 40 @
+	{0x1F, 0x05, 0x1F}, // 41 A
+	{0x1F, 0x15, 0x1B}, // 42 B
+	{0x0E, 0x11, 0x11}, // 43 C
+	{0x1F, 0x11, 0x1E}, // 44 D
+	{0x1F, 0x15, 0x11}, // 45 E
+	{0x1F, 0x05, 0x01}, // 46 F
+	{0x1E, 0x11, 0x19}, // 47 G
+	{0x1F, 0x04, 0x1F}, // 48 H
+	{0x11, 0x1F, 0x11}, // 49 I
+	{0x11, 0x1F, 0x01}, // 4a J
+	{0x1F, 0x04, 0x1B}, // 4b K
+	{0x1F, 0x10, 0x10}, // 4c L
+	{0x1F, 0x03, 0x1F}, // 4d M
+	{0x1F, 0x01, 0x1E}, // 4e N
+	{0x1E, 0x11, 0x0F}, // 4f O
+	{0x1F, 0x05, 0x07}, // 50 P
+	{0x0E, 0x19, 0x17}, // 51 Q
+	{0x1F, 0x05, 0x1B}, // 52 R
+	{0x16, 0x15, 0x0D}, // 53 S
+	{0x01, 0x1F, 0x01}, // 54 T
+	{0x0F, 0x10, 0x1F}, // 55 U
+	{0x0F, 0x10, 0x0F}, // 56 V
+	{0x1F, 0x18, 0x1F}, // 57 W
+	{0x1B, 0x04, 0x1B}, // 58 X
+	{0x07, 0x18, 0x07}, // 59 Y
+	{0x19, 0x15, 0x13}, // 5a Z
+	{0x1F, 0x11, 0x00}, // 5b [
+	{0x01, 0x0E, 0x10}, // 5c '\'
+	{0x00, 0x11, 0x1F}, // 5d ]
+	{0x02, 0x01, 0x02}, // 5e ^
+	{0x10, 0x10, 0x10}, // 5f _
+	{0x00, 0x01, 0x02}, // 60 `
+	{0x1F, 0x05, 0x1F}, // 61 a
+	{0x1F, 0x15, 0x1B}, // 62 b
+	{0x0E, 0x11, 0x11}, // 63 c
+	{0x1F, 0x11, 0x1E}, // 64 d
+	{0x1F, 0x15, 0x11}, // 65 e
+	{0x1F, 0x05, 0x01}, // 66 f
+	{0x1E, 0x11, 0x19}, // 67 g
+	{0x1F, 0x04, 0x1F}, // 68 h
+	{0x11, 0x1F, 0x11}, // 69 i
+	{0x11, 0x1F, 0x01}, // 6a j
+	{0x1F, 0x04, 0x1B}, // 6b k
+	{0x1F, 0x10, 0x10}, // 6c l
+	{0x1F, 0x03, 0x1F}, // 6d m
+	{0x1F, 0x01, 0x1E}, // 6e n
+	{0x1E, 0x11, 0x0F}, // 6f o
+	{0x1F, 0x05, 0x07}, // 70 p
+	{0x0E, 0x19, 0x17}, // 71 q
+	{0x1F, 0x05, 0x1B}, // 72 r
+	{0x16, 0x15, 0x0D}, // 73 s
+	{0x01, 0x1F, 0x01}, // 74 t
+	{0x0F, 0x10, 0x1F}, // 75 u
+	{0x0F, 0x10, 0x0F}, // 76 v
+	{0x1F, 0x18, 0x1F}, // 77 w
+	{0x1B, 0x04, 0x1B}, // 78 x
+	{0x07, 0x18, 0x07}, // 79 y
+	{0x19, 0x15, 0x13}, // 7a z
+	{0x04, 0x1B, 0x11}, // 7b {
+	{0x00, 0x1F, 0x00}, // 7c |
+	{0x11, 0x1B, 0x04}, // 7d }
+	{0x0C, 0x04, 0x06}, // 7e ~
+	{0x00, 0x00, 0x00}, // 7f DEL
+};
+
+// wraps and scrolls within the clip rectangle
 void LCD_Wrap() {
-	if (LCD_text_X + LCD_CHAR_WIDTH >= LCD_WIDTH) {
-		LCD_text_X = 0;
+	int x1, y1, x2, y2;
+	LCD_GetClip(&x1, &y1, &x2, &y2);
+	if (LCD_text_X + LCD_CHAR_WIDTH > x2) {
+		LCD_text_X = x1;
 		LCD_text_Y += LCD_CHAR_HEIGHT + 1;
 	}
-	if (LCD_text_Y + LCD_CHAR_HEIGHT >= LCD_HEIGHT) {
-		LCD_Scroll(0, LCD_HEIGHT - (LCD_text_Y + LCD_CHAR_HEIGHT));
-		LCD_text_Y = LCD_HEIGHT - LCD_CHAR_HEIGHT;
+	if (LCD_text_Y + LCD_CHAR_HEIGHT > y2) {
+		LCD_Scroll(0, y2 + 1 - (LCD_text_Y + LCD_CHAR_HEIGHT));
+		LCD_text_Y = y2 + 1 - LCD_CHAR_HEIGHT;
 	}
 }
 
@@ -42,6 +152,191 @@ void LCD_PrintN(const char *string, size_t n) {
 	}
 }
 
+typedef struct {
+	int wrap;
+	int count;
+} LCD_Output;
+
+static void LCD_Emit(LCD_Output *out, char c) {
+	int x1, y1, x2, y2;
+	if (c == '\n') {
+		LCD_GetClip(&x1, &y1, &x2, &y2);
+		LCD_text_X = x1;
+		LCD_text_Y += LCD_CHAR_HEIGHT + 1;
+		return;
+	}
+	if ((unsigned char)c < 0x20 || (unsigned char)c > 0x7F) return;
+	if (out->wrap) LCD_Wrap();
+	LCD_PutChar(c);
+	++out->count;
+}
+
+static void LCD_EmitRepeat(LCD_Output *out, char c, int n) {
+	while (n-- > 0) {
+		LCD_Emit(out, c);
+	}
+}
+
+// Digits are produced backwards in a small array, then padded while emitted:
+// the leading zeros asked for by the precision are only counted, as the
+// precision is not bounded.
+static void LCD_EmitNumber(LCD_Output *out, unsigned long long value, int negative,
+                           unsigned int base, int upper, int width, int precision,
+                           int fraction, int left, int zero) {
+	const char *symbols = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+	char digits[24];
+	int n = 0, total, length;
+
+	while (value) {
+		digits[n++] = symbols[value % base];
+		value /= base;
+	}
+	total = n;
+	if (fraction) {
+		// at least one integer digit before the point
+		if (total <= fraction) total = fraction + 1;
+	}
+	else {
+		if (precision < 0) precision = 1;
+		if (total < precision) total = precision;
+	}
+
+	length = total + negative + (fraction ? 1 : 0);
+	if (!left && !zero) LCD_EmitRepeat(out, ' ', width - length);
+	if (negative) LCD_Emit(out, '-');
+	if (!left && zero) LCD_EmitRepeat(out, '0', width - length);
+	while (total--) {
+		LCD_Emit(out, total < n ? digits[total] : '0');
+		if (fraction && total == fraction) LCD_Emit(out, '.');
+	}
+	if (left) LCD_EmitRepeat(out, ' ', width - length);
+}
+
+static int LCD_Format(int wrap, const char *format, va_list args) {
+	LCD_Output out = { wrap, 0 };
+	int left, zero, width, precision, size, length;
+	long long value;
+	unsigned long long magnitude;
+	const char *string;
+
+	while (*format) {
+		if (*format != '%') {
+			LCD_Emit(&out, *format++);
+			continue;
+		}
+		++format;
+
+		left = zero = 0;
+		for (;; ++format) {
+			if (*format == '-') left = 1;
+			else if (*format == '0') zero = 1;
+			else break;
+		}
+
+		width = 0;
+		if (*format == '*') {
+			width = va_arg(args, int);
+			if (width < 0) {
+				left = 1;
+				width = -width;
+			}
+			++format;
+		}
+		while (*format >= '0' && *format <= '9') {
+			width = width * 10 + *format++ - '0';
+		}
+
+		precision = -1;
+		if (*format == '.') {
+			++format;
+			precision = 0;
+			if (*format == '*') {
+				precision = va_arg(args, int);
+				++format;
+			}
+			while (*format >= '0' && *format <= '9') {
+				precision = precision * 10 + *format++ - '0';
+			}
+		}
+
+		size = 0;
+		while (*format == 'l') {
+			++size;
+			++format;
+		}
+
+		switch (*format) {
+		case 'd':
+		case 'i':
+		case 'k':
+			value = size > 1 ? va_arg(args, long long) : size ? va_arg(args, long) : va_arg(args, int);
+			magnitude = value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+			if (*format == 'k')
+				LCD_EmitNumber(&out, magnitude, value < 0, 10, 0, width, -1, precision < 0 ? 0 : precision, left, zero);
+			else
+				LCD_EmitNumber(&out, magnitude, value < 0, 10, 0, width, precision, 0, left, zero && precision < 0);
+			break;
+		case 'u':
+		case 'x':
+		case 'X':
+			magnitude = size > 1 ? va_arg(args, unsigned long long) : size ? va_arg(args, unsigned long) : va_arg(args, unsigned int);
+			LCD_EmitNumber(&out, magnitude, 0, *format == 'u' ? 10 : 16, *format == 'X',
+			               width, precision, 0, left, zero && precision < 0);
+			break;
+		case 'c':
+			if (!left) LCD_EmitRepeat(&out, ' ', width - 1);
+			LCD_Emit(&out, (char)va_arg(args, int));
+			if (left) LCD_EmitRepeat(&out, ' ', width - 1);
+			break;
+		case 's':
+			string = va_arg(args, const char *);
+			if (!string) string = "(null)";
+			for (length = 0; string[length] && (precision < 0 || length < precision); ++length);
+			if (!left) LCD_EmitRepeat(&out, ' ', width - length);
+			for (size = 0; size < length; ++size) {
+				LCD_Emit(&out, string[size]);
+			}
+			if (left) LCD_EmitRepeat(&out, ' ', width - length);
+			break;
+		case '%':
+			LCD_Emit(&out, '%');
+			break;
+		case '\0':
+			return out.count;
+		default:
+			break;
+		}
+		++format;
+	}
+	return out.count;
+}
+
+int LCD_Textf(const char *format, ...) {
+	va_list args;
+	int count;
+	va_start(args, format);
+	count = LCD_Format(0, format, args);
+	va_end(args);
+	return count;
+}
+
+int LCD_vTextf(const char *format, va_list args) {
+	return LCD_Format(0, format, args);
+}
+
+int LCD_Printf(const char *format, ...) {
+	va_list args;
+	int count;
+	va_start(args, format);
+	count = LCD_Format(1, format, args);
+	va_end(args);
+	return count;
+}
+
+int LCD_vPrintf(const char *format, va_list args) {
+	return LCD_Format(1, format, args);
+}
+
 void LCD_TextMode(LCD_COLOR mode) {
 	LCD_text_mode = mode;
 }
@@ -49,4 +344,6 @@ void LCD_TextMode(LCD_COLOR mode) {
 void LCD_TextLocate(int x, int y) {
 	LCD_text_X = x;
 	LCD_text_Y = y;
-}
\ No newline at end of file
+}
+
+#endif
@@ -0,0 +1,102 @@
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "frame.h"
+
+// absolute CLOCK_MONOTONIC time timeout_ms from now, NULL for none (-1)
+static struct timespec *deadline(struct timespec *ts, int timeout_ms) {
+    if (timeout_ms < 0) return NULL;
+    clock_gettime(CLOCK_MONOTONIC, ts);
+    ts->tv_sec += timeout_ms / 1000;
+    ts->tv_nsec += (timeout_ms % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) {
+        ++ts->tv_sec;
+        ts->tv_nsec -= 1000000000L;
+    }
+    return ts;
+}
+
+// Returns 1 once the deadline has passed. Wakes, spurious or not, and EAGAIN
+// (the word had already changed) return 0 for the caller to check again.
+static int futex_wait(unsigned int *word, unsigned int value, const struct timespec *until) {
+    return syscall(SYS_futex, word, FUTEX_WAIT_BITSET_PRIVATE, value, until, NULL,
+                   FUTEX_BITSET_MATCH_ANY) == -1 && errno == ETIMEDOUT;
+}
+
+static void futex_wake(unsigned int *word) {
+    syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+
+void LCD_FrameInit(LCD_Frame *frame, unsigned char *buffer, int width, int height, int regions) {
+    int banks = height / 8;
+    frame->buffer = buffer ? buffer : LCD_GetTarget();
+    frame->width = width;
+    frame->height = height;
+    frame->regions = regions < 1 ? 1 : regions > banks ? banks : regions;
+    frame->pending = 0;
+    frame->generation = 0;
+    frame->stopped = 0;
+}
+
+// bank rows are dealt evenly, the first regions get the remainder
+void LCD_FrameRegion(const LCD_Frame *frame, int index, int *x1, int *y1, int *x2, int *y2) {
+    int banks = frame->height / 8;
+    int share = banks / frame->regions, extra = banks % frame->regions;
+    int first = index * share + (index < extra ? index : extra);
+    int count = share + (index < extra ? 1 : 0);
+    *x1 = 0;
+    *x2 = frame->width - 1;
+    *y1 = first * 8;
+    *y2 = (first + count) * 8 - 1;
+}
+
+void LCD_FrameStart(LCD_Frame *frame) {
+    __atomic_store_n(&frame->pending, frame->regions, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&frame->generation, 1, __ATOMIC_RELEASE);
+    futex_wake(&frame->generation);
+}
+
+// 1 once every region was submitted, 0 on timeout (ms, -1 for none)
+int LCD_FrameWait(LCD_Frame *frame, int timeout_ms) {
+    struct timespec ts, *until = deadline(&ts, timeout_ms);
+    unsigned int pending;
+    int expired = 0;
+    for (;;) {
+        pending = __atomic_load_n(&frame->pending, __ATOMIC_ACQUIRE);
+        if (!pending) return 1;
+        if (expired || timeout_ms == 0) return 0;
+        expired = futex_wait(&frame->pending, pending, until);
+    }
+}
+
+// workers waiting in LCD_FrameNext return 0
+void LCD_FrameStop(LCD_Frame *frame) {
+    __atomic_store_n(&frame->stopped, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&frame->generation, 1, __ATOMIC_RELEASE);
+    futex_wake(&frame->generation);
+}
+
+int LCD_FrameNext(LCD_Frame *frame, unsigned int *generation, int timeout_ms) {
+    struct timespec ts, *until = deadline(&ts, timeout_ms);
+    unsigned int current;
+    int expired = 0;
+    for (;;) {
+        current = __atomic_load_n(&frame->generation, __ATOMIC_ACQUIRE);
+        if (current != *generation) break;
+        if (expired || timeout_ms == 0) return 0;
+        expired = futex_wait(&frame->generation, current, until);
+    }
+    *generation = current;
+    if (__atomic_load_n(&frame->stopped, __ATOMIC_RELAXED)) return 0;
+    if (frame->width == LCD_WIDTH && frame->height == LCD_HEIGHT)
+        LCD_SetTarget(frame->buffer);
+    return 1;
+}
+
+void LCD_FrameSubmit(LCD_Frame *frame) {
+    if (__atomic_sub_fetch(&frame->pending, 1, __ATOMIC_ACQ_REL) == 0)
+        futex_wake(&frame->pending);
+}
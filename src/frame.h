@@ -0,0 +1,51 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include "lcd.h"
+
+// Multi-threaded frame rendering.
+// A frame is split into regions of whole bank rows, one per worker thread.
+// Regions share no byte of the buffer, so workers draw without locks; the
+// drawing target, clip stack and text cursor are per thread. The presenting thread
+// starts a frame, workers render their region and submit it, and the last
+// submission wakes the presenter, which can then display the frame.
+//
+//     worker:    while (LCD_FrameNext(&frame, &seen, -1)) { draw(region); LCD_FrameSubmit(&frame); }
+//     presenter: LCD_FrameStart(&frame); LCD_FrameWait(&frame, -1); LCD_Display();
+//
+// On screen-sized frames a worker can LCD_PushClip() its region so that
+// primitives cannot stray into the others; larger buffers are only clipped to
+// the screen size, so workers must keep to their region themselves.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    unsigned char *buffer; // LCD_Buffer layout, width bytes per bank row
+    int width, height; // height is a multiple of 8
+    int regions;
+    unsigned int pending; // regions not submitted yet, futex word
+    unsigned int generation; // frames started, futex word
+    int stopped;
+} LCD_Frame;
+
+// buffer of width by height pixels, NULL for the current drawing target
+void LCD_FrameInit(LCD_Frame *frame, unsigned char *buffer, int width, int height, int regions);
+void LCD_FrameRegion(const LCD_Frame *frame, int index, int *x1, int *y1, int *x2, int *y2);
+
+// presenter side
+void LCD_FrameStart(LCD_Frame *frame);
+int LCD_FrameWait(LCD_Frame *frame, int timeout_ms);
+void LCD_FrameStop(LCD_Frame *frame);
+
+// worker side, generation starts at 0. Screen sized frames become the
+// drawing target of the calling thread.
+int LCD_FrameNext(LCD_Frame *frame, unsigned int *generation, int timeout_ms);
+void LCD_FrameSubmit(LCD_Frame *frame);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
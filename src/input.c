@@ -0,0 +1,315 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "input.h"
+
+#if defined(LCD_EMULATED)
+#include <SDL2/SDL.h>
+#elif !defined(LCD_HEADLESS)
+#include <wiringPi.h>
+#endif
+
+#define MASK (LCD_INPUT_QUEUE - 1)
+
+// Bounded multi-producer queue. Each cell carries a sequence number telling
+// whether it is ready to be written (seq == pos) or read (seq == pos + 1).
+// Sequences are stored relative to the cell index so that a zeroed queue is
+// a valid empty one.
+typedef struct {
+    unsigned int seq;
+    LCD_Event event;
+} Cell;
+
+static Cell cells[LCD_INPUT_QUEUE];
+static unsigned int enqueue_pos, dequeue_pos;
+static unsigned int events; // futex word, bumped on every push
+
+static LCD_InputCallback input_callback = NULL;
+static void *input_user = NULL;
+
+// key state and debouncing
+static int key_state[LCD_KEY_COUNT];
+static unsigned long long key_time[LCD_KEY_COUNT];
+
+static unsigned long long now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static int enqueue(const LCD_Event *event) {
+    unsigned int pos = __atomic_load_n(&enqueue_pos, __ATOMIC_RELAXED), seq;
+    Cell *cell;
+    for (;;) {
+        cell = &cells[pos & MASK];
+        seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) + (pos & MASK);
+        if ((int)(seq - pos) == 0) {
+            if (__atomic_compare_exchange_n(&enqueue_pos, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+        else if ((int)(seq - pos) < 0) return 1; // full
+        else pos = __atomic_load_n(&enqueue_pos, __ATOMIC_RELAXED);
+    }
+    cell->event = *event;
+    __atomic_store_n(&cell->seq, pos + 1 - (pos & MASK), __ATOMIC_RELEASE);
+    return 0;
+}
+
+static int dequeue(LCD_Event *event) {
+    unsigned int pos = __atomic_load_n(&dequeue_pos, __ATOMIC_RELAXED), seq;
+    Cell *cell;
+    for (;;) {
+        cell = &cells[pos & MASK];
+        seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) + (pos & MASK);
+        if ((int)(seq - (pos + 1)) == 0) {
+            if (__atomic_compare_exchange_n(&dequeue_pos, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+        else if ((int)(seq - (pos + 1)) < 0) return 1; // empty
+        else pos = __atomic_load_n(&dequeue_pos, __ATOMIC_RELAXED);
+    }
+    *event = cell->event;
+    __atomic_store_n(&cell->seq, pos + LCD_INPUT_QUEUE - (pos & MASK), __ATOMIC_RELEASE);
+    return 0;
+}
+
+// debounce: a key must keep its state for LCD_INPUT_DEBOUNCE_US before changing
+// again, returns the microseconds left before it may
+static unsigned long long lockout(LCD_KEY key, unsigned long long time) {
+    unsigned long long since;
+    if (key <= LCD_KEY_NONE || key >= LCD_KEY_COUNT) return 0;
+    since = time - key_time[key];
+    return since < LCD_INPUT_DEBOUNCE_US ? LCD_INPUT_DEBOUNCE_US - since : 0;
+}
+
+static int push(LCD_KEY key, int pressed, int debounce) {
+    LCD_Event event;
+    unsigned long long time = now_us();
+
+    if (key <= LCD_KEY_NONE || key >= LCD_KEY_COUNT) return 1;
+    pressed = !!pressed;
+    if (__atomic_load_n(&key_state[key], __ATOMIC_RELAXED) == pressed) return 1;
+    if (debounce && lockout(key, time)) return 1;
+
+    event.key = key;
+    event.pressed = pressed;
+    event.time_us = time;
+    if (enqueue(&event)) return 1; // full, the key keeps its previous state
+    __atomic_store_n(&key_state[key], pressed, __ATOMIC_RELAXED);
+    key_time[key] = time;
+
+    if (input_callback) input_callback(&event, input_user);
+    __atomic_add_fetch(&events, 1, __ATOMIC_RELEASE);
+    syscall(SYS_futex, &events, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+    return 0;
+}
+
+int LCD_InputPush(LCD_KEY key, int pressed) {
+    return push(key, pressed, 0);
+}
+
+void LCD_InputSetCallback(LCD_InputCallback callback, void *user) {
+    input_user = user;
+    input_callback = callback;
+}
+
+int LCD_InputNext(LCD_Event *event) {
+    return dequeue(event) == 0;
+}
+
+// returns 1 with an event, 0 on timeout (-1 waits forever)
+int LCD_InputWait(LCD_Event *event, int timeout_ms) {
+    unsigned long long deadline = now_us() + (unsigned long long)timeout_ms * 1000ULL, left = 0;
+    struct timespec ts;
+    unsigned int seen;
+#if defined(LCD_EMULATED)
+    SDL_Event sdl;
+    int more;
+#endif
+
+    for (;;) {
+        seen = __atomic_load_n(&events, __ATOMIC_ACQUIRE);
+        if (dequeue(event) == 0) return 1;
+        if (timeout_ms >= 0) {
+            if (now_us() >= deadline) return 0;
+            left = deadline - now_us();
+        }
+#if defined(LCD_EMULATED)
+        // SDL only reports keys while its events are pumped: sdl_watch pushes
+        // them, the queue is drained here so that the wait blocks again
+        more = SDL_WaitEventTimeout(&sdl, timeout_ms < 0 ? 10 : (left / 1000 < 10 ? (int)(left / 1000) : 10));
+        while (more) {
+            if (sdl.type == SDL_QUIT) {
+                SDL_Quit();
+                exit(0);
+            }
+            more = SDL_PollEvent(&sdl);
+        }
+        (void)seen;
+        (void)ts;
+#else
+        ts.tv_sec = timeout_ms < 0 ? 1 : left / 1000000ULL;
+        ts.tv_nsec = timeout_ms < 0 ? 0 : (left % 1000000ULL) * 1000;
+        syscall(SYS_futex, &events, FUTEX_WAIT_PRIVATE, seen, &ts, NULL, 0);
+#endif
+    }
+}
+
+int LCD_InputPressed(LCD_KEY key) {
+    if (key <= LCD_KEY_NONE || key >= LCD_KEY_COUNT) return 0;
+    return __atomic_load_n(&key_state[key], __ATOMIC_RELAXED);
+}
+
+static const char *key_names[LCD_KEY_COUNT] = {
+    "none", "up", "down", "left", "right", "a", "b", "start", "select"
+};
+
+static LCD_KEY key_from_name(const char *name) {
+    int key;
+    for (key = LCD_KEY_UP; key < LCD_KEY_COUNT; ++key) {
+        if (!strcmp(name, key_names[key])) return key;
+    }
+    return LCD_KEY_NONE;
+}
+
+static void *script_thread(void *data) {
+    FILE *file = data;
+    char line[128], name[16], state[16];
+    unsigned long long start = now_us(), at;
+    unsigned long ms;
+    struct timespec ts;
+
+    while (fgets(line, sizeof(line), file)) {
+        if (line[0] == '#' || sscanf(line, "%lu %15s %15s", &ms, name, state) != 3) continue;
+        at = start + ms * 1000ULL;
+        if (now_us() < at) {
+            ts.tv_sec = (at - now_us()) / 1000000ULL;
+            ts.tv_nsec = ((at - now_us()) % 1000000ULL) * 1000;
+            nanosleep(&ts, NULL);
+        }
+        push(key_from_name(name), !strcmp(state, "down"), 0);
+    }
+    fclose(file);
+    return NULL;
+}
+
+int LCD_InputScript(const char *path) {
+    pthread_t thread;
+    FILE *file = fopen(path, "r");
+    if (!file) return 1;
+    if (pthread_create(&thread, NULL, script_thread, file)) {
+        fclose(file);
+        return 1;
+    }
+    pthread_detach(thread);
+    return 0;
+}
+
+#if defined(LCD_EMULATED)
+
+static LCD_KEY key_from_sdl(SDL_Keycode code) {
+    switch (code) {
+    case SDLK_UP: return LCD_KEY_UP;
+    case SDLK_DOWN: return LCD_KEY_DOWN;
+    case SDLK_LEFT: return LCD_KEY_LEFT;
+    case SDLK_RIGHT: return LCD_KEY_RIGHT;
+    case SDLK_z: return LCD_KEY_A;
+    case SDLK_x: return LCD_KEY_B;
+    case SDLK_RETURN: return LCD_KEY_START;
+    case SDLK_BACKSPACE: return LCD_KEY_SELECT;
+    default: return LCD_KEY_NONE;
+    }
+}
+
+// runs whenever SDL pumps events, be it in LCD_Display or LCD_InputWait
+static int sdl_watch(void *data, SDL_Event *event) {
+    (void)data;
+    if ((event->type == SDL_KEYDOWN || event->type == SDL_KEYUP) && !event->key.repeat)
+        push(key_from_sdl(event->key.keysym.sym), event->type == SDL_KEYDOWN, 0);
+    return 1;
+}
+
+int LCD_InputInit() {
+    SDL_AddEventWatch(sdl_watch, NULL);
+    return 0;
+}
+
+int LCD_InputGPIO(int pin, LCD_KEY key) {
+    (void)pin;
+    (void)key;
+    return 1;
+}
+
+#elif defined(LCD_HEADLESS)
+
+int LCD_InputInit() {
+    return 0;
+}
+
+int LCD_InputGPIO(int pin, LCD_KEY key) {
+    (void)pin;
+    (void)key;
+    return 1;
+}
+
+#else
+
+static int gpio_count = 0;
+static int gpio_pin[LCD_INPUT_MAX_PINS];
+static LCD_KEY gpio_key[LCD_INPUT_MAX_PINS];
+
+// Buttons pull the pin low. An edge inside the debounce window is not
+// dropped: the handler thread, one per pin, waits the window out and samples
+// the pin again, so a release bouncing right after the press still gets
+// through. Edges during the wait are latched and handled on return.
+static void gpio_edge(int i) {
+    unsigned long long left;
+    struct timespec ts;
+    while ((left = lockout(gpio_key[i], now_us())) != 0) {
+        ts.tv_sec = left / 1000000ULL;
+        ts.tv_nsec = (left % 1000000ULL) * 1000;
+        nanosleep(&ts, NULL);
+    }
+    push(gpio_key[i], !digitalRead(gpio_pin[i]), 1);
+}
+
+// wiringPi interrupt handlers take no argument, one per slot
+#define GPIO_HANDLER(n) static void gpio_isr_##n() { gpio_edge(n); }
+GPIO_HANDLER(0)
+GPIO_HANDLER(1)
+GPIO_HANDLER(2)
+GPIO_HANDLER(3)
+GPIO_HANDLER(4)
+GPIO_HANDLER(5)
+GPIO_HANDLER(6)
+GPIO_HANDLER(7)
+
+static void (*const gpio_handlers[LCD_INPUT_MAX_PINS])() = {
+    gpio_isr_0, gpio_isr_1, gpio_isr_2, gpio_isr_3,
+    gpio_isr_4, gpio_isr_5, gpio_isr_6, gpio_isr_7
+};
+
+int LCD_InputInit() {
+    return 0;
+}
+
+int LCD_InputGPIO(int pin, LCD_KEY key) {
+    if (gpio_count == LCD_INPUT_MAX_PINS) return 1;
+    gpio_pin[gpio_count] = pin;
+    gpio_key[gpio_count] = key;
+    pinMode(pin, INPUT);
+    pullUpDnControl(pin, PUD_UP);
+    if (wiringPiISR(pin, INT_EDGE_BOTH, gpio_handlers[gpio_count]) < 0) return 1;
+    ++gpio_count;
+    return 0;
+}
+
+#endif
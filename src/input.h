@@ -0,0 +1,50 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include "lcd.h"
+
+// Input events, independent of LCD_Display.
+// Producers (GPIO edge interrupts, SDL keyboard, scripted files) push
+// timestamped events on a lock-free queue; the frame loop pops them, blocks
+// until one arrives, or gets them through a callback as soon as they happen.
+
+#define LCD_INPUT_QUEUE 64 // power of two
+#define LCD_INPUT_MAX_PINS 8
+#define LCD_INPUT_DEBOUNCE_US 5000
+
+typedef enum {
+    LCD_KEY_NONE = 0,
+    LCD_KEY_UP,
+    LCD_KEY_DOWN,
+    LCD_KEY_LEFT,
+    LCD_KEY_RIGHT,
+    LCD_KEY_A,
+    LCD_KEY_B,
+    LCD_KEY_START,
+    LCD_KEY_SELECT,
+    LCD_KEY_COUNT
+} LCD_KEY;
+
+typedef struct {
+    LCD_KEY key;
+    int pressed;
+    unsigned long long time_us; // CLOCK_MONOTONIC
+} LCD_Event;
+
+// called from the producer's thread, which may be an interrupt handler thread
+typedef void (*LCD_InputCallback)(const LCD_Event *event, void *user);
+
+int LCD_InputInit();
+void LCD_InputSetCallback(LCD_InputCallback callback, void *user);
+
+// GPIO button wired to ground with the internal pull-up, physical builds only
+int LCD_InputGPIO(int pin, LCD_KEY key);
+// replays "<ms> <key> <down|up>" lines, key being up, down, left, right, a, b, start or select
+int LCD_InputScript(const char *path);
+int LCD_InputPush(LCD_KEY key, int pressed);
+
+int LCD_InputNext(LCD_Event *event);
+int LCD_InputWait(LCD_Event *event, int timeout_ms);
+int LCD_InputPressed(LCD_KEY key);
+
+#endif
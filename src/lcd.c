@@ -1,24 +1,58 @@
-#include <stdlib.h>
-#include <stdio.h>
+#include <stddef.h>
 #include "lcd.h"
 
-#define sgn(x)  (x<0?-1:1)
-#define rnd(x)  ((int)(x+0.5))
-#define abs(x)  (x<0?-x:x)
-
 //The DC pin tells the LCD if we are sending a command or data
 typedef enum {
-    COMMAND = 0,
-    DATA = 1
+    COMMAND = LCD_BUS_COMMAND,
+    DATA = LCD_BUS_DATA
 } LCD_TYPE;
 
 // screen buffer
 // all drawing operations are made internally on the buffer
 // the buffer is then sent to the LCD screen via LCD_Display()
-static LCD_Buffer LCD_buffer;
+#ifndef LCD_NO_FRAMEBUFFER
+static LCD_Buffer LCD_screen;
+#else
+#define LCD_screen NULL
+#endif
+
+// drawing target, the screen buffer unless redirected with LCD_SetTarget().
+// Each thread has its own, so threads can render to different buffers.
+static LCD_THREAD_LOCAL unsigned char *LCD_buffer = LCD_screen;
 LCD_COLOR LCD_PixelGet(int x, int y);
 
-#ifndef LCD_EMULATED
+// every byte sent to the controller is also reported to the bus hook, if any
+static LCD_BusHook LCD_bus_hook = NULL;
+static LCD_TYPE LCD_type = COMMAND;
+
+// controller in power-down mode, see LCD_SetPowerDown()
+static int LCD_powered_down = 0;
+
+// Each backend provides LCD_Setup() to initialize its hardware, LCD_Present()
+// called after each transmission, and the LCD_Write* bus primitives.
+// The byte stream itself (LCD_Init, LCD_Display) is the same for all of them.
+
+#if defined(LCD_HEADLESS) || defined(LCD_FREESTANDING)
+
+// No display at all, the screen buffer is only read back by the caller.
+// Freestanding ports send the bytes reported to the bus hook over their own
+// SPI peripheral, driving DC from the byte type and CE until LCD_BUS_END.
+#define LCD_WriteTransmit(on)
+#define LCD_WriteType(type)
+#define LCD_WriteByte(byte)
+
+static int LCD_Setup() {
+    return 0;
+}
+
+static void LCD_Present() {
+}
+
+void LCD_SetBacklight(int on) {
+    (void)on;
+}
+
+#elif !defined(LCD_EMULATED)
 
 #include <wiringPi.h> // for core GPIO functions
 #include <wiringShift.h> // for shiftOut()
@@ -41,12 +75,11 @@ LCD_COLOR LCD_PixelGet(int x, int y);
 
 #define PIN_LIGHT 0
 
-#define LCD_StartTransmit() digitalWrite(PIN_SCE, LOW)
-#define LCD_EndTransmit() digitalWrite(PIN_SCE, HIGH)
-#define LCD_SetType(type) digitalWrite(PIN_DC, type)
-#define LCD_SendByte(byte) shiftOut(PIN_SDIN, PIN_SCLK, MSBFIRST, byte);
+#define LCD_WriteTransmit(on) digitalWrite(PIN_SCE, (on) ? LOW : HIGH)
+#define LCD_WriteType(type) digitalWrite(PIN_DC, type)
+#define LCD_WriteByte(byte) shiftOut(PIN_SDIN, PIN_SCLK, MSBFIRST, byte)
 
-int LCD_Init() {
+static int LCD_Setup() {
 
     wiringPiSetup(); //setup the wiringPi library to use GPIO mapping
 
@@ -62,38 +95,10 @@ int LCD_Init() {
     digitalWrite(PIN_RESET, LOW);
     digitalWrite(PIN_RESET, HIGH);
 
-    LCD_StartTransmit();
-    LCD_SetType(COMMAND);
-
-    LCD_SendByte(0x21); //Tell LCD that extended commands follow
-    LCD_SendByte(0xB0); //Set LCD Vop (Contrast): Try 0xB1(good @ 3.3V) or 0xBF if your display is too dark
-    LCD_SendByte(0x04); //Set Temp coefficent
-    LCD_SendByte(0x14); //LCD bias mode 1:48: Try 0x13 or 0x14
-
-    LCD_SendByte(0x20); //We must send 0x20 before modifying the display control mode
-    LCD_SendByte(0x0C); //Set display control, normal mode. 0x0D for inverse
-
-    LCD_EndTransmit();
-
     return 0;
 }
 
-void LCD_Display() {
-    size_t i;
-    LCD_StartTransmit();
-
-    // reset position to 0,0
-    LCD_SetType(COMMAND);
-    LCD_SendByte(0x40);
-    LCD_SendByte(0x80);
-
-    // send buffer
-    LCD_SetType(DATA);
-    for (i = 0 ; i < sizeof(LCD_buffer) ; ++i) {
-        LCD_SendByte(LCD_buffer[i]);
-    }
-
-    LCD_EndTransmit();
+static void LCD_Present() {
 }
 
 void LCD_SetBacklight(int on) {
@@ -102,12 +107,35 @@ void LCD_SetBacklight(int on) {
 
 #else
 
+#include <stdlib.h>
+#include <stdio.h>
 #include <SDL2/SDL.h>
+#include "pcd8544.h"
 
 static SDL_Window *win;
 static SDL_Renderer *ren;
 
-int LCD_Init() {
+// SPI clock of the emulated bus, for the transfer times of the controller
+#ifndef LCD_EMULATED_CLOCK
+#define LCD_EMULATED_CLOCK 4000000
+#endif
+
+// the window shows what the simulated controller would from the byte stream
+static LCD_PCD8544 LCD_panel;
+
+#define LCD_WriteTransmit(on) do { \
+        if (!(on)) LCD_PCD8544Write(&LCD_panel, LCD_BUS_END, 0); \
+    } while (0)
+#define LCD_WriteType(type)
+#define LCD_WriteByte(byte) LCD_PCD8544Write(&LCD_panel, (LCD_BUS)LCD_type, byte)
+
+const LCD_PCD8544 *LCD_EmulatedPanel() {
+    return &LCD_panel;
+}
+
+static int LCD_Setup() {
+
+    LCD_PCD8544Reset(&LCD_panel, LCD_EMULATED_CLOCK);
 
     if (SDL_Init(SDL_INIT_VIDEO))
     {
@@ -123,7 +151,9 @@ int LCD_Init() {
         return 1;
     }
 
-    ren = SDL_CreateRenderer(win, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    // no vsync: the window is presented after every transmission, and the
+    // spans or rows of one frame must not wait for a refresh each
+    ren = SDL_CreateRenderer(win, -1, SDL_RENDERER_ACCELERATED);
     if (ren == NULL) {
         SDL_DestroyWindow(win);
         printf("SDL_CreateRenderer Error: %s\n", SDL_GetError());
@@ -134,8 +164,10 @@ int LCD_Init() {
     return 0;
 }
 
-void LCD_Display() {
+// the SDL window is cheap enough to redraw as a whole
+static void LCD_Present() {
     int x, y;
+    LCD_Buffer shown;
     SDL_Event event;
     SDL_Rect pixel = {
         .x = 0, .y = 0,
@@ -144,9 +176,10 @@ void LCD_Display() {
     SDL_SetRenderDrawColor(ren, 255, 255, 255, 255);
     SDL_RenderClear(ren);
     SDL_SetRenderDrawColor(ren, 0, 0, 0, 255);
+    LCD_PCD8544Show(&LCD_panel, shown);
     for (y = 0; y < LCD_HEIGHT; ++y) {
         for (x = 0; x < LCD_WIDTH; ++x) {
-            if (LCD_PixelGet(x, y) == BLACK)
+            if (shown[ x + (y / 8 * LCD_WIDTH) ] & (1 << (y % 8)))
             {
                 pixel.x = x * LCD_PIXEL_SIZE_X;
                 pixel.y = y * LCD_PIXEL_SIZE_Y;
@@ -175,66 +208,356 @@ void LCD_SetBacklight(int on) {
 
 #endif
 
-// TODO: improve genericity
-#define CLIP_X(pos) (pos < 0 ? 0 : (pos > LCD_WIDTH ? LCD_WIDTH : pos))
-#define CLIP_Y(pos) (pos < 0 ? 0 : (pos > LCD_HEIGHT ? LCD_HEIGHT : pos))
-#define TEST_X(pos) (pos < 0 ? 0 : (pos >= LCD_WIDTH ? 0 : 1))
-#define TEST_Y(pos) (pos < 0 ? 0 : (pos >= LCD_HEIGHT ? 0 : 1))
+// after the backends, whose headers may declare abs()
+#define sgn(x)  (x<0?-1:1)
+#define rnd(x)  ((int)(x+0.5))
+#define abs(x)  (x<0?-x:x)
 
-void LCD_Clear() {
+#define LCD_StartTransmit() LCD_WriteTransmit(1)
+#define LCD_EndTransmit() do { \
+        LCD_WriteTransmit(0); \
+        if (LCD_bus_hook) LCD_bus_hook(LCD_BUS_END, 0); \
+    } while (0)
+#define LCD_SetType(type) do { \
+        LCD_type = type; \
+        LCD_WriteType(type); \
+    } while (0)
+#define LCD_SendByte(byte) do { \
+        if (LCD_bus_hook) LCD_bus_hook((LCD_BUS)LCD_type, byte); \
+        LCD_WriteByte(byte); \
+    } while (0)
+
+void LCD_SetBusHook(LCD_BusHook hook) {
+    LCD_bus_hook = hook;
+}
+
+int LCD_Init() {
+
+    if (LCD_Setup() != 0) return 1;
+
+    LCD_StartTransmit();
+    LCD_SetType(COMMAND);
+
+    LCD_SendByte(0x21); //Tell LCD that extended commands follow
+    LCD_SendByte(0xB0); //Set LCD Vop (Contrast): Try 0xB1(good @ 3.3V) or 0xBF if your display is too dark
+    LCD_SendByte(0x04); //Set Temp coefficent
+    LCD_SendByte(0x14); //LCD bias mode 1:48: Try 0x13 or 0x14
+
+    LCD_SendByte(0x20); //We must send 0x20 before modifying the display control mode
+    LCD_SendByte(0x0C); //Set display control, normal mode. 0x0D for inverse
+
+    LCD_EndTransmit();
+    LCD_powered_down = 0;
+
+    return 0;
+}
+
+// The PCD8544 keeps its settings in power-down, so waking up only takes a
+// function set with PD cleared. Its display RAM must be zeroed beforehand to
+// reach the specified current, hence a frame must be sent after waking up.
+void LCD_SetPowerDown(int on) {
     size_t i;
-    for (i = 0 ; i < sizeof(LCD_buffer) ; ++i) {
-        LCD_buffer[i] = 0;
+    if (!!on == LCD_powered_down) return;
+    LCD_powered_down = !!on;
+
+    LCD_StartTransmit();
+    if (on) {
+        LCD_SetType(COMMAND);
+        LCD_SendByte(0x40);
+        LCD_SendByte(0x80);
+        LCD_SetType(DATA);
+        for (i = 0 ; i < sizeof(LCD_Buffer) ; ++i) {
+            LCD_SendByte(0);
+        }
     }
+    LCD_SetType(COMMAND);
+    LCD_SendByte(on ? 0x24 : 0x20); // function set, PD bit
+    LCD_EndTransmit();
+    LCD_Present();
 }
 
-void LCD_Invert() {
+#ifndef LCD_NO_FRAMEBUFFER
+
+void LCD_Display() {
     size_t i;
-    for (i = 0 ; i < sizeof(LCD_buffer) ; ++i) {
-        LCD_buffer[i] ^= 0xFF;
+    LCD_StartTransmit();
+
+    // reset position to 0,0
+    LCD_SetType(COMMAND);
+    LCD_SendByte(0x40);
+    LCD_SendByte(0x80);
+
+    // send buffer
+    LCD_SetType(DATA);
+    for (i = 0 ; i < sizeof(LCD_screen) ; ++i) {
+        LCD_SendByte(LCD_screen[i]);
     }
+
+    LCD_EndTransmit();
+    LCD_Present();
 }
 
-void LCD_Pixel(int x, int y, LCD_COLOR color) {
+void LCD_DisplaySpan(int bank, int x1, int x2) {
+    int x;
+    if (bank < 0 || bank >= LCD_HEIGHT / 8) return;
+    x1 = x1 < 0 ? 0 : x1;
+    x2 = x2 >= LCD_WIDTH ? LCD_WIDTH - 1 : x2;
+    if (x1 > x2) return;
+
+    LCD_StartTransmit();
+
+    // move the address counter to the start of the span
+    LCD_SetType(COMMAND);
+    LCD_SendByte(0x40 | bank);
+    LCD_SendByte(0x80 | x1);
+
+    LCD_SetType(DATA);
+    for (x = x1; x <= x2; ++x) {
+        LCD_SendByte(LCD_screen[x + bank * LCD_WIDTH]);
+    }
+
+    LCD_EndTransmit();
+    LCD_Present();
+}
+
+#endif
+
+// sends a bank row rendered outside of the screen buffer
+void LCD_DisplayRow(int bank, const unsigned char *row) {
+    int x;
+    if (bank < 0 || bank >= LCD_HEIGHT / 8) return;
+
+    LCD_StartTransmit();
+
+    LCD_SetType(COMMAND);
+    LCD_SendByte(0x40 | bank);
+    LCD_SendByte(0x80);
+
+    LCD_SetType(DATA);
+    for (x = 0; x < LCD_WIDTH; ++x) {
+        LCD_SendByte(row[x]);
+    }
+
+    LCD_EndTransmit();
+    LCD_Present();
+}
+
+// Clip rectangle, inclusive and in target coordinates, and origin of the
+// drawing coordinates, per thread. Primitives translate their arguments and
+// intersect them with the clip rectangle once per call.
+typedef struct {
+    int x1, y1, x2, y2;
+    int ox, oy;
+} LCD_Clip;
+
+static LCD_THREAD_LOCAL LCD_Clip LCD_clip = { 0, 0, LCD_WIDTH - 1, LCD_HEIGHT - 1, 0, 0 };
+static LCD_THREAD_LOCAL LCD_Clip LCD_clip_stack[LCD_CLIP_DEPTH];
+static LCD_THREAD_LOCAL int LCD_clip_depth = 0;
+
+// Bank rows held by the drawing target, all of them unless set with
+// LCD_SetTargetRows(), and the clip rectangle limited to these rows, which is
+// what primitives clip against.
+static LCD_THREAD_LOCAL int LCD_target_bank = 0;
+static LCD_THREAD_LOCAL int LCD_target_banks = LCD_HEIGHT / 8;
+static LCD_THREAD_LOCAL LCD_Clip LCD_view = { 0, 0, LCD_WIDTH - 1, LCD_HEIGHT - 1, 0, 0 };
+
+#define LCD_ROW(b) (LCD_buffer + ((b) - LCD_target_bank) * LCD_WIDTH)
+
+#define LCD_CLIP_FULL() (LCD_view.x1 == 0 && LCD_view.y1 == 0 && \
+                         LCD_view.x2 == LCD_WIDTH - 1 && LCD_view.y2 == LCD_HEIGHT - 1)
+
+static void LCD_UpdateView() {
+    LCD_view = LCD_clip;
+    if (LCD_view.y1 < LCD_target_bank * 8) LCD_view.y1 = LCD_target_bank * 8;
+    if (LCD_view.y2 >= (LCD_target_bank + LCD_target_banks) * 8)
+        LCD_view.y2 = (LCD_target_bank + LCD_target_banks) * 8 - 1;
+}
+
+// bits of bank b lying between rows y1 and y2
+static unsigned char LCD_BankMask(int b, int y1, int y2) {
+    unsigned char mask = 0xFF;
+    if (y1 > b * 8) mask &= 0xFF << (y1 - b * 8);
+    if (y2 < b * 8 + 7) mask &= 0xFF >> (b * 8 + 7 - y2);
+    return mask;
+}
+
+static int LCD_Push(int x1, int y1, int x2, int y2, int viewport) {
+    int t;
+    if (LCD_clip_depth == LCD_CLIP_DEPTH) return 1;
+    LCD_clip_stack[LCD_clip_depth++] = LCD_clip;
+    if (x1 > x2) {
+        t = x1;
+        x1 = x2;
+        x2 = t;
+    }
+    if (y1 > y2) {
+        t = y1;
+        y1 = y2;
+        y2 = t;
+    }
+    x1 += LCD_clip.ox;
+    x2 += LCD_clip.ox;
+    y1 += LCD_clip.oy;
+    y2 += LCD_clip.oy;
+    if (viewport) {
+        LCD_clip.ox = x1;
+        LCD_clip.oy = y1;
+    }
+    // an empty intersection leaves x1 > x2 or y1 > y2, which clips everything
+    if (x1 > LCD_clip.x1) LCD_clip.x1 = x1;
+    if (y1 > LCD_clip.y1) LCD_clip.y1 = y1;
+    if (x2 < LCD_clip.x2) LCD_clip.x2 = x2;
+    if (y2 < LCD_clip.y2) LCD_clip.y2 = y2;
+    LCD_UpdateView();
+    return 0;
+}
+
+int LCD_PushClip(int x1, int y1, int x2, int y2) {
+    return LCD_Push(x1, y1, x2, y2, 0);
+}
+
+int LCD_PushViewport(int x1, int y1, int x2, int y2) {
+    return LCD_Push(x1, y1, x2, y2, 1);
+}
+
+void LCD_PopClip() {
+    if (LCD_clip_depth) LCD_clip = LCD_clip_stack[--LCD_clip_depth];
+    LCD_UpdateView();
+}
+
+void LCD_GetClip(int *x1, int *y1, int *x2, int *y2) {
+    *x1 = LCD_clip.x1 - LCD_clip.ox;
+    *y1 = LCD_clip.y1 - LCD_clip.oy;
+    *x2 = LCD_clip.x2 - LCD_clip.ox;
+    *y2 = LCD_clip.y2 - LCD_clip.oy;
+}
+
+void LCD_GetOrigin(int *x, int *y) {
+    *x = LCD_clip.ox;
+    *y = LCD_clip.oy;
+}
+
+void LCD_SetTarget(unsigned char *buffer) {
+    LCD_buffer = buffer ? buffer : LCD_screen;
+    LCD_target_bank = 0;
+    LCD_target_banks = LCD_HEIGHT / 8;
+    LCD_UpdateView();
+}
+
+void LCD_SetTargetRows(unsigned char *buffer, int bank, int banks) {
+    LCD_buffer = buffer;
+    LCD_target_bank = bank;
+    LCD_target_banks = banks;
+    LCD_UpdateView();
+}
+
+unsigned char *LCD_GetTarget() {
+    return LCD_buffer;
+}
+
+// The *Clipped helpers take target coordinates and clip against LCD_view.
+
+static void LCD_PixelClipped(int x, int y, LCD_COLOR color) {
     unsigned char *ptr;
-    if (TEST_X(x) && TEST_Y(y)) {
-        ptr = &LCD_buffer[ x + (y / 8 * LCD_WIDTH) ];
+    if (x < LCD_view.x1 || x > LCD_view.x2 || y < LCD_view.y1 || y > LCD_view.y2) return;
+    ptr = &LCD_ROW(y / 8)[x];
+    switch (color) {
+    case WHITE:
+        *ptr &= ~(1 << (y % 8)); // erase pixel
+        break;
+    case BLACK:
+        *ptr |= 1 << (y % 8); // write requested pixel
+        break;
+    case XOR:
+        *ptr ^= 1 << (y % 8); // write requested pixel
+        break;
+    default:
+        break;
+    }
+}
+
+static void LCD_FillRectClipped(int x1, int y1, int x2, int y2, LCD_COLOR color) {
+    int x, b;
+    unsigned char mask, *row;
+
+    if (x1 < LCD_view.x1) x1 = LCD_view.x1;
+    if (y1 < LCD_view.y1) y1 = LCD_view.y1;
+    if (x2 > LCD_view.x2) x2 = LCD_view.x2;
+    if (y2 > LCD_view.y2) y2 = LCD_view.y2;
+    if (x1 > x2 || y1 > y2) return;
+
+    for (b = y1 / 8; b <= y2 / 8; ++b) {
+        mask = LCD_BankMask(b, y1, y2);
+        row = LCD_ROW(b);
         switch (color) {
         case WHITE:
-            *ptr &= ~(1 << (y % 8)); // erase pixel
+            mask = ~mask;
+            for (x = x1; x <= x2; ++x)
+                row[x] &= mask;
             break;
         case BLACK:
-            *ptr |= 1 << (y % 8); // write requested pixel
+            for (x = x1; x <= x2; ++x)
+                row[x] |= mask;
             break;
         case XOR:
-            *ptr ^= 1 << (y % 8); // write requested pixel
+            for (x = x1; x <= x2; ++x)
+                row[x] ^= mask;
             break;
         default:
-            break;
+            return;
         }
     }
 }
 
+void LCD_Clear() {
+    size_t i;
+    if (!LCD_CLIP_FULL()) {
+        LCD_FillRectClipped(LCD_view.x1, LCD_view.y1, LCD_view.x2, LCD_view.y2, WHITE);
+        return;
+    }
+    for (i = 0 ; i < sizeof(LCD_Buffer) ; ++i) {
+        LCD_buffer[i] = 0;
+    }
+}
+
+void LCD_Invert() {
+    size_t i;
+    if (!LCD_CLIP_FULL()) {
+        LCD_FillRectClipped(LCD_view.x1, LCD_view.y1, LCD_view.x2, LCD_view.y2, XOR);
+        return;
+    }
+    for (i = 0 ; i < sizeof(LCD_Buffer) ; ++i) {
+        LCD_buffer[i] ^= 0xFF;
+    }
+}
+
+void LCD_Pixel(int x, int y, LCD_COLOR color) {
+    LCD_PixelClipped(x + LCD_view.ox, y + LCD_view.oy, color);
+}
+
 LCD_COLOR LCD_PixelGet(int x, int y) {
-    if (!(TEST_X(x) && TEST_Y(y))) return UNDEFINED;
+    x += LCD_view.ox;
+    y += LCD_view.oy;
+    if (x < 0 || x >= LCD_WIDTH || y < LCD_target_bank * 8 || y >= (LCD_target_bank + LCD_target_banks) * 8)
+        return UNDEFINED;
     return !! // double negation (forces true to 1 and false to 0)
            (
-               LCD_buffer[ x + (y / 8 * LCD_WIDTH) ] & // location on buffer (y / 8)
+               LCD_ROW(y / 8)[x] & // location on buffer (y / 8)
                (1 << (y % 8)) // get the appropriate bit from the byte (y % 8)
            );
 }
 
 void LCD_DrawLine(int x1, int y1, int x2, int y2, LCD_COLOR color) {
     int i, x, y, dx, dy, sx, sy, cumul;
-    x = x1;
-    y = y1;
+    x = x1 + LCD_view.ox;
+    y = y1 + LCD_view.oy;
     dx = x2 - x1;
     dy = y2 - y1;
     sx = sgn(dx);
     sy = sgn(dy);
     dx = abs(dx);
     dy = abs(dy);
-    LCD_Pixel(x, y, color);
+    LCD_PixelClipped(x, y, color);
     if (dx > dy)
     {
         cumul = dx / 2;
@@ -247,7 +570,7 @@ void LCD_DrawLine(int x1, int y1, int x2, int y2, LCD_COLOR color) {
                 cumul -= dx;
                 y += sy;
             }
-            LCD_Pixel(x, y, color);
+            LCD_PixelClipped(x, y, color);
         }
     }
     else
@@ -262,198 +585,148 @@ void LCD_DrawLine(int x1, int y1, int x2, int y2, LCD_COLOR color) {
                 cumul -= dy;
                 x += sx;
             }
-            LCD_Pixel(x, y, color);
+            LCD_PixelClipped(x, y, color);
         }
     }
 }
 
 void LCD_HorizontalLine(int y, int x1, int x2, LCD_COLOR color) {
     int x;
-    unsigned char byte;
-    if (TEST_Y(y) && (TEST_X(x1) || TEST_X(x2)))
-    {
-        if (x1 > x2) {
-            x = x1;
-            x1 = x2;
-            x2 = x;
-        }
-        x1 = CLIP_X(x1);
-        x2 = CLIP_X(x2);
-
-        byte = 1 << (y % 8);
-
-        switch (color) {
-        case WHITE:
-            byte = ~byte;
-            for (x = x1; x <= x2; ++x)
-                LCD_buffer[ x + (y / 8 * LCD_WIDTH) ] &= byte;
-            break;
-        case BLACK:
-            for (x = x1; x <= x2; ++x)
-                LCD_buffer[ x + (y / 8 * LCD_WIDTH) ] |= byte;
-            break;
-        case XOR:
-            for (x = x1; x <= x2; ++x)
-                LCD_buffer[ x + (y / 8 * LCD_WIDTH) ] ^= byte;
-            break;
-        default:
-            break;
-        }
+    if (x1 > x2) {
+        x = x1;
+        x1 = x2;
+        x2 = x;
     }
+    y += LCD_view.oy;
+    LCD_FillRectClipped(x1 + LCD_view.ox, y, x2 + LCD_view.ox, y, color);
 }
 
 void LCD_VerticalLine(int x, int y1, int y2, LCD_COLOR color) {
     int y;
-    ++y2;
-    if (TEST_X(x) && (TEST_Y(y1) || TEST_Y(y2)))
-    {
-        if (y1 > y2) {
-            y = y1;
-            y1 = y2;
-            y2 = y;
-        }
-        y1 = CLIP_Y(y1);
-        y2 = CLIP_Y(y2);
-
-        switch (color) {
-        case WHITE:
-            if (y1 / 8 != y2 / 8) {
-                LCD_buffer[ x + (y1 / 8 * LCD_WIDTH) ] &= ~(0xFF << (y1 % 8));
-                LCD_buffer[ x + (y2 / 8 * LCD_WIDTH) ] &= (0xFF << (y2 % 8));
-                for (y = (y1 / 8) + 1; y < (y2 / 8); y++) {
-                    LCD_buffer[ x + (y * LCD_WIDTH) ] = 0;
-                }
-            }
-            else LCD_buffer[ x + (y1 / 8 * LCD_WIDTH) ] &= ~((0xFF << (y1 % 8)) & ~(0xFF << (y2 % 8)));
-            break;
-        case BLACK:
-            if (y1 / 8 != y2 / 8) {
-                LCD_buffer[ x + (y1 / 8 * LCD_WIDTH) ] |= 0xFF << (y1 % 8);
-                LCD_buffer[ x + (y2 / 8 * LCD_WIDTH) ] |= ~(0xFF << (y2 % 8));
-                for (y = (y1 / 8) + 1; y < (y2 / 8); y++) {
-                    LCD_buffer[ x + (y * LCD_WIDTH) ] = 0xFF;
-                }
-            }
-            else LCD_buffer[ x + (y1 / 8 * LCD_WIDTH) ] |= (0xFF << (y1 % 8)) & ~(0xFF << (y2 % 8));
-            break;
-        case XOR:
-            if (y1 / 8 != y2 / 8) {
-                LCD_buffer[ x + (y1 / 8 * LCD_WIDTH) ] ^= 0xFF << (y1 % 8);
-                LCD_buffer[ x + (y2 / 8 * LCD_WIDTH) ] ^= ~(0xFF << (y2 % 8));
-                for (y = (y1 / 8) + 1; y < (y2 / 8); y++) {
-                    LCD_buffer[ x + (y * LCD_WIDTH) ] ^= 0xFF;
-                }
-            }
-            else LCD_buffer[ x + (y1 / 8 * LCD_WIDTH) ] ^= (0xFF << (y1 % 8)) & ~(0xFF << (y2 % 8));
-            break;
-        default:
-            break;
-        }
+    if (y1 > y2) {
+        y = y1;
+        y1 = y2;
+        y2 = y;
     }
+    x += LCD_view.ox;
+    LCD_FillRectClipped(x, y1 + LCD_view.oy, x, y2 + LCD_view.oy, color);
 }
 
-void LCD_Blit(const unsigned char *buffer, int x1, int y1, int w, int h, LCD_COLOR mode) {
-    int x, y;
-    unsigned int index = 0;
-    unsigned char byte = 0;
-    unsigned char buffa, buffb;
-
-    for (y = 0; y * 8 < h; ++y) {
-        for (x = 0; x < w; ++x) {
-            if (TEST_X(x + x1))
-            {
-                byte = buffer[index];
-                if (y >= h / 8)
-                {
-                    switch (mode & MODE) {
-                    case AND:
-                        byte |= ~(0xFF >> (8 - (h % 8)));
-                        break;
-                    default:
-                        byte &= 0xFF >> (8 - (h % 8));
-                        break;
-                    }
-                }
-                buffa = byte << ((y1 % 8 + 8) % 8);
-                buffb = byte >> (8 - (y1 % 8 + 8) % 8);
+// Source rows are shifted into one or two target banks; the part of each
+// bank byte covered by the source and the clip rectangle is blended at once.
+static void LCD_BlitClipped(const unsigned char *buffer, int x1, int y1, int w, int h, LCD_COLOR mode) {
+    int x, y, b, cx1, cx2, shift, rows, half;
+    unsigned int rowmask, src, mask;
+    unsigned char *dst, part, cover;
+
+    cx1 = x1 < LCD_view.x1 ? LCD_view.x1 : x1;
+    cx2 = x1 + w - 1 > LCD_view.x2 ? LCD_view.x2 : x1 + w - 1;
+    if (cx1 > cx2 || h <= 0 || LCD_view.y1 > LCD_view.y2) return;
+
+    shift = y1 & 7; // y1 mod 8, also for negative y1
+    rows = (h + 7) / 8;
+    for (y = 0; y < rows; ++y) {
+        rowmask = y == rows - 1 && h % 8 ? 0xFFu >> (8 - h % 8) : 0xFF;
+        mask = rowmask << shift;
+        for (half = 0; half < 2; ++half) {
+            b = (y1 - shift) / 8 + y + half; // floor(y1 / 8) + y + half
+            if (b < LCD_view.y1 / 8 || b > LCD_view.y2 / 8) continue;
+            cover = (unsigned char)(mask >> (8 * half)) & LCD_BankMask(b, LCD_view.y1, LCD_view.y2);
+            if (!cover) continue;
+            dst = LCD_ROW(b);
+            for (x = cx1; x <= cx2; ++x) {
+                src = ((unsigned int)buffer[y * w + x - x1] & rowmask) << shift;
+                part = (unsigned char)(src >> (8 * half)) & cover;
                 switch (mode & MODE) {
                 case OR:
-                    if (TEST_Y(y1 + y * 8))
-                        LCD_buffer[x1 + x + (y * 8 + y1) / 8 * LCD_WIDTH] |= buffa;
-                    if (TEST_Y(y1 + y * 8 + 8))
-                        LCD_buffer[x1 + x + (y * 8 + y1 + 8) / 8 * LCD_WIDTH] |= buffb;
+                    dst[x] |= part;
                     break;
+#ifndef LCD_NO_BLIT_MODES
                 case AND:
-                    buffa |= 0xFF >> (8 - y1 % 8);
-                    buffb |= 0xFF << (y1 % 8);
-                    if (TEST_Y(y1 + y * 8))
-                        LCD_buffer[x1 + x + (y * 8 + y1) / 8 * LCD_WIDTH] &= buffa;
-                    if (TEST_Y(y1 + y * 8 + 8))
-                        LCD_buffer[x1 + x + (y * 8 + y1 + 8) / 8 * LCD_WIDTH] &= buffb;
+                    dst[x] &= part | ~cover;
                     break;
                 case XOR:
-                    if (TEST_Y(y1 + y * 8))
-                        LCD_buffer[x1 + x + (y * 8 + y1) / 8 * LCD_WIDTH] ^= buffa;
-                    if (TEST_Y(y1 + y * 8 + 8))
-                        LCD_buffer[x1 + x + (y * 8 + y1 + 8) / 8 * LCD_WIDTH] ^= buffb;
+                    dst[x] ^= part;
                     break;
+#endif
                 default:
                     break;
                 }
-                if (mode & NOT)
-                {
-                    byte = 0xFF;
-                    if (y >= h / 8)
-                    {
-                        byte = byte >> (8 - (h % 8));
-                    }
-                    if (TEST_Y(y1 + y * 8))
-                        LCD_buffer[x1 + x + (y * 8 + y1) / 8 * LCD_WIDTH] ^= byte << (y1 % 8);
-                    if (TEST_Y(y1 + y * 8 + 8))
-                        LCD_buffer[x1 + x + (y * 8 + y1 + 8) / 8 * LCD_WIDTH] ^= byte >> (8 - y1 % 8);
-                }
+#ifndef LCD_NO_BLIT_MODES
+                if (mode & NOT) dst[x] ^= cover;
+#endif
             }
-            ++index;
         }
     }
 }
 
-
+void LCD_Blit(const unsigned char *buffer, int x1, int y1, int w, int h, LCD_COLOR mode) {
+#ifdef LCD_NO_BLIT_MODES
+    mode = OR;
+#endif
+    LCD_BlitClipped(buffer, x1 + LCD_view.ox, y1 + LCD_view.oy, w, h, mode);
+}
 
 void LCD_FillRect(int x1, int y1, int x2, int y2, LCD_COLOR color) {
-    int x;
+    int t;
     if (x1 > x2) {
-        x = x1;
+        t = x1;
         x1 = x2;
-        x2 = x;
+        x2 = t;
     }
-    for (x = x1; x <= x2; ++x) {
-        LCD_VerticalLine(x, y1, y2, color);
+    if (y1 > y2) {
+        t = y1;
+        y1 = y2;
+        y2 = t;
     }
-
+    LCD_FillRectClipped(x1 + LCD_view.ox, y1 + LCD_view.oy, x2 + LCD_view.ox, y2 + LCD_view.oy, color);
 }
 
+// the four sides do not overlap, so XOR outlines are closed
 void LCD_DrawRect(int x1, int y1, int x2, int y2, LCD_COLOR color) {
-    LCD_VerticalLine(x1, y1 + 1, y2, color);
-    LCD_VerticalLine(x2, y1, y2 - 1, color);
-    LCD_HorizontalLine(y1, x1, x2 - 1, color);
-    LCD_HorizontalLine(y2, x1 + 1, x2, color);
+    int t;
+    if (x1 > x2) {
+        t = x1;
+        x1 = x2;
+        x2 = t;
+    }
+    if (y1 > y2) {
+        t = y1;
+        y1 = y2;
+        y2 = t;
+    }
+    x1 += LCD_view.ox;
+    x2 += LCD_view.ox;
+    y1 += LCD_view.oy;
+    y2 += LCD_view.oy;
+    if (x1 == x2 || y1 == y2) {
+        LCD_FillRectClipped(x1, y1, x2, y2, color);
+        return;
+    }
+    LCD_FillRectClipped(x1, y1 + 1, x1, y2, color);
+    LCD_FillRectClipped(x2, y1, x2, y2 - 1, color);
+    LCD_FillRectClipped(x1, y1, x2 - 1, y1, color);
+    LCD_FillRectClipped(x1 + 1, y2, x2, y2, color);
 }
 
+#ifndef LCD_NO_CIRCLES
+
 void LCD_DrawCircle(int x, int y, int radius, LCD_COLOR color) {
     int plot_x, plot_y, d;
 
     if (radius < 0) return;
+    x += LCD_view.ox;
+    y += LCD_view.oy;
     plot_x = 0;
     plot_y = radius;
     d = 1 - radius;
 
-    LCD_Pixel(x, y + plot_y, color);
+    LCD_PixelClipped(x, y + plot_y, color);
     if (radius)
     {
-        LCD_Pixel(x, y - plot_y, color);
-        LCD_Pixel(x + plot_y, y, color);
-        LCD_Pixel(x - plot_y, y, color);
+        LCD_PixelClipped(x, y - plot_y, color);
+        LCD_PixelClipped(x + plot_y, y, color);
+        LCD_PixelClipped(x - plot_y, y, color);
     }
     while (plot_y > plot_x)
     {
@@ -467,17 +740,17 @@ void LCD_DrawCircle(int x, int y, int radius, LCD_COLOR color) {
         plot_x++;
         if (plot_y >= plot_x)
         {
-            LCD_Pixel(x + plot_x, y + plot_y, color);
-            LCD_Pixel(x - plot_x, y + plot_y, color);
-            LCD_Pixel(x + plot_x, y - plot_y, color);
-            LCD_Pixel(x - plot_x, y - plot_y, color);
+            LCD_PixelClipped(x + plot_x, y + plot_y, color);
+            LCD_PixelClipped(x - plot_x, y + plot_y, color);
+            LCD_PixelClipped(x + plot_x, y - plot_y, color);
+            LCD_PixelClipped(x - plot_x, y - plot_y, color);
         }
         if (plot_y > plot_x)
         {
-            LCD_Pixel(x + plot_y, y + plot_x, color);
-            LCD_Pixel(x - plot_y, y + plot_x, color);
-            LCD_Pixel(x + plot_y, y - plot_x, color);
-            LCD_Pixel(x - plot_y, y - plot_x, color);
+            LCD_PixelClipped(x + plot_y, y + plot_x, color);
+            LCD_PixelClipped(x - plot_y, y + plot_x, color);
+            LCD_PixelClipped(x + plot_y, y - plot_x, color);
+            LCD_PixelClipped(x - plot_y, y - plot_x, color);
         }
     }
 }
@@ -486,11 +759,13 @@ void LCD_FillCircle(int x, int y, int radius, LCD_COLOR color) {
     int plot_y, plot_x, d;
 
     if (radius < 0) return;
+    x += LCD_view.ox;
+    y += LCD_view.oy;
     plot_y = 0;
     plot_x = radius;
     d = 1 - radius;
 
-    LCD_VerticalLine(x, y - plot_x, y + plot_x, color);
+    LCD_FillRectClipped(x, y - plot_x, x, y + plot_x, color);
     while (plot_x > plot_y)
     {
         if (d < 0)
@@ -498,39 +773,46 @@ void LCD_FillCircle(int x, int y, int radius, LCD_COLOR color) {
         else {
             d += 2 * (plot_y - plot_x) + 5;
             plot_x--;
-            LCD_VerticalLine(x + plot_x + 1, y - plot_y, y + plot_y, color);
-            LCD_VerticalLine(x - plot_x - 1, y - plot_y, y + plot_y, color);
+            LCD_FillRectClipped(x + plot_x + 1, y - plot_y, x + plot_x + 1, y + plot_y, color);
+            LCD_FillRectClipped(x - plot_x - 1, y - plot_y, x - plot_x - 1, y + plot_y, color);
         }
         plot_y++;
         if (plot_x >= plot_y)
         {
-            LCD_VerticalLine(x + plot_y, y - plot_x, y + plot_x, color);
-            LCD_VerticalLine(x - plot_y, y - plot_x, y + plot_x, color);
+            LCD_FillRectClipped(x + plot_y, y - plot_x, x + plot_y, y + plot_x, color);
+            LCD_FillRectClipped(x - plot_y, y - plot_x, x - plot_y, y + plot_x, color);
         }
     }
 }
 
+#endif
+
+// scrolls the content of the clip rectangle, clearing what is uncovered
 void LCD_Scroll(int x, int y) {
-    unsigned char buffer[LCD_WIDTH * LCD_HEIGHT / 8];
-    int i;
-    for (i = 0; i < LCD_WIDTH * LCD_HEIGHT / 8; ++i)
-    {
-        buffer[i] = LCD_buffer[i];
+    LCD_Buffer buffer;
+    int b, c;
+    unsigned char mask;
+    if (LCD_view.x1 > LCD_view.x2 || LCD_view.y1 > LCD_view.y2) return;
+    for (b = 0; b < LCD_HEIGHT / 8; ++b) {
+        mask = b < LCD_view.y1 / 8 || b > LCD_view.y2 / 8 ? 0 : LCD_BankMask(b, LCD_view.y1, LCD_view.y2);
+        for (c = 0; c < LCD_WIDTH; ++c) {
+            buffer[c + b * LCD_WIDTH] = c < LCD_view.x1 || c > LCD_view.x2 || !mask ? 0 : LCD_ROW(b)[c] & mask;
+        }
     }
-    LCD_Clear();
-    LCD_Blit(buffer, x, y, LCD_WIDTH, LCD_HEIGHT, OR);
+    LCD_FillRectClipped(LCD_view.x1, LCD_view.y1, LCD_view.x2, LCD_view.y2, WHITE);
+    LCD_BlitClipped(buffer, x, y, LCD_WIDTH, LCD_HEIGHT, OR);
 }
 
 void LCD_SaveScreen(LCD_Buffer buffer) {
     size_t i;
-    for (i = 0 ; i < sizeof(LCD_buffer) ; ++i) {
+    for (i = 0 ; i < sizeof(LCD_Buffer) ; ++i) {
         buffer[i] = LCD_buffer[i];
     }
 }
 
 void LCD_RestoreScreen(LCD_Buffer buffer) {
     size_t i;
-    for (i = 0 ; i < sizeof(LCD_buffer) ; ++i) {
+    for (i = 0 ; i < sizeof(LCD_Buffer) ; ++i) {
         LCD_buffer[i] = buffer[i];
     }
 }
@@ -2,6 +2,21 @@
 #define LCD_H
 
 // #define LCD_EMULATED // to emulate LCD display using SDL
+// #define LCD_HEADLESS // no display, for servers and automated runs
+// #define LCD_FREESTANDING // no libc, the bus hook drives the panel (microcontrollers)
+
+// Features that can be left out of small builds
+// #define LCD_NO_TEXT // font.h
+// #define LCD_NO_CIRCLES // LCD_DrawCircle and LCD_FillCircle
+// #define LCD_NO_BLIT_MODES // LCD_Blit only ORs
+// #define LCD_NO_FRAMEBUFFER // no screen buffer, frames are streamed (stream.h)
+
+// drawing state kept per thread (drawing target, clip stack, text cursor)
+#if defined(LCD_FREESTANDING)
+#define LCD_THREAD_LOCAL
+#else
+#define LCD_THREAD_LOCAL __thread
+#endif
 
 // You may find a different size screen, but this one is 84 by 48 pixels
 #define LCD_WIDTH     84
@@ -12,6 +27,10 @@
 #define LCD_PIXEL_SIZE_X 6
 #define LCD_PIXEL_SIZE_Y 7
  
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 typedef unsigned char LCD_Buffer[LCD_WIDTH * LCD_HEIGHT / 8];
 
 // LCD_COLOR is used both for pixel color and blitting modes
@@ -31,9 +50,22 @@ typedef enum {
     NOT   = 8,  // 1000 
 } LCD_COLOR;
 
+// bytes sent to the controller, as reported to the bus hook
+typedef enum {
+    LCD_BUS_COMMAND = 0,
+    LCD_BUS_DATA = 1,
+    LCD_BUS_END = 2, // end of a transmission, byte is unused
+} LCD_BUS;
+
+typedef void (*LCD_BusHook)(LCD_BUS type, unsigned char byte);
+
 int LCD_Init();
 void LCD_Display();
+void LCD_DisplaySpan(int bank, int x1, int x2);
+void LCD_DisplayRow(int bank, const unsigned char *row);
 void LCD_SetBacklight(int on);
+void LCD_SetPowerDown(int on); // blanks the panel, send a frame after waking it up
+void LCD_SetBusHook(LCD_BusHook hook);
 void LCD_Clear();
 void LCD_Invert();
 void LCD_Pixel(int x, int y, LCD_COLOR color);
@@ -43,11 +75,39 @@ void LCD_HorizontalLine(int y, int x1, int x2, LCD_COLOR color);
 void LCD_VerticalLine(int x, int y1, int y2, LCD_COLOR color);
 void LCD_FillRect(int x1, int y1, int x2, int y2, LCD_COLOR color);
 void LCD_DrawRect(int x1, int y1, int x2, int y2, LCD_COLOR color);
+#ifndef LCD_NO_CIRCLES
 void LCD_DrawCircle(int x, int y, int radius, LCD_COLOR color);
 void LCD_FillCircle(int x, int y, int radius, LCD_COLOR color);
+#endif
 void LCD_Blit(const unsigned char *buffer, int x1, int y1, int w, int h, LCD_COLOR mode);
 void LCD_Scroll(int x, int y);
 void LCD_SaveScreen(LCD_Buffer buffer);
 void LCD_RestoreScreen(LCD_Buffer buffer);
 
+// Clip rectangles and viewports, per thread, honored by every primitive and
+// the text renderer. LCD_PushClip restricts drawing to a rectangle given in
+// current coordinates; LCD_PushViewport also moves the origin to its top left
+// corner, so nested widgets draw in their own coordinates. Pushing returns 1
+// when the stack is full.
+#define LCD_CLIP_DEPTH 8
+int LCD_PushClip(int x1, int y1, int x2, int y2);
+int LCD_PushViewport(int x1, int y1, int x2, int y2);
+void LCD_PopClip();
+void LCD_GetClip(int *x1, int *y1, int *x2, int *y2); // in current coordinates
+void LCD_GetOrigin(int *x, int *y); // in target coordinates
+
+// redirect drawing operations of the calling thread to another buffer, NULL for the screen
+void LCD_SetTarget(unsigned char *buffer);
+unsigned char *LCD_GetTarget();
+
+// Redirects drawing to a buffer holding only bank rows bank to bank + banks - 1,
+// LCD_WIDTH bytes each; drawing is clipped to these rows. LCD_SaveScreen,
+// LCD_RestoreScreen and the modules writing to LCD_GetTarget() directly need
+// a whole screen target.
+void LCD_SetTargetRows(unsigned char *buffer, int bank, int banks);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
@@ -0,0 +1,198 @@
+#ifndef LCD_HPP
+#define LCD_HPP
+
+#include "lcd.h"
+
+// Header-only C++ rendering core.
+// Surfaces use the LCD_Buffer layout (bank rows of 8 pixels, LSB on top) and
+// can wrap the C screen buffer, so both APIs can draw on the same frame.
+// Sizes and blending modes are template parameters: every call site compiles
+// to a loop specialized for its mode, with no switch on LCD_COLOR inside.
+//
+//     lcd::Screen screen(LCD_GetTarget());
+//     screen.fill_rect<XOR>(10, 10, 30, 20);
+//     screen.blit<OR>(sprite, x, y, 16, 16);
+
+namespace lcd {
+
+// bits 0..n-1
+inline constexpr unsigned char low_mask[9] = {
+    0x00, 0x01, 0x03, 0x07, 0x0F, 0x1F, 0x3F, 0x7F, 0xFF
+};
+
+// bits n..7
+inline constexpr unsigned char high_mask[9] = {
+    0xFF, 0xFE, 0xFC, 0xF8, 0xF0, 0xE0, 0xC0, 0x80, 0x00
+};
+
+inline constexpr unsigned char bit_mask[8] = {
+    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80
+};
+
+// Blending of src into dst, limited to the bits set in mask (src has no bit
+// outside of mask). Drawing colors are expressed as blits of a solid source:
+// WHITE is AND with nothing, BLACK is OR with everything.
+template <LCD_COLOR Mode>
+struct Blend {
+    static_assert((Mode & MODE) <= AND, "unsupported LCD_COLOR");
+
+    static constexpr unsigned char solid(unsigned char mask) {
+        return (Mode & MODE) == WHITE ? 0 : mask;
+    }
+
+    static constexpr unsigned char apply(unsigned char dst, unsigned char src, unsigned char mask) {
+        return (unsigned char)((
+            (Mode & MODE) == WHITE ? dst & ~mask :
+            (Mode & MODE) == BLACK ? dst | mask :
+            (Mode & MODE) == XOR ? dst ^ src :
+            (Mode & MODE) == OR ? dst | src :
+            dst & (src | ~mask)
+        ) ^ ((Mode & NOT) ? mask : 0));
+    }
+};
+
+template <int W, int H>
+class Surface {
+    static_assert(W > 0 && H > 0 && H % 8 == 0, "surfaces are made of whole bank rows");
+
+public:
+    static constexpr int width = W;
+    static constexpr int height = H;
+    static constexpr int banks = H / 8;
+    static constexpr int size = W * H / 8;
+
+    explicit Surface(unsigned char *buffer) : buffer(buffer) {}
+
+    unsigned char *data() const {
+        return buffer;
+    }
+
+    void clear() const {
+        for (int i = 0; i < size; ++i)
+            buffer[i] = 0;
+    }
+
+    bool get(int x, int y) const {
+        if ((unsigned)x >= (unsigned)W || (unsigned)y >= (unsigned)H) return false;
+        return buffer[x + (y >> 3) * W] & bit_mask[y & 7];
+    }
+
+    template <LCD_COLOR Mode>
+    void pixel(int x, int y) const {
+        if ((unsigned)x >= (unsigned)W || (unsigned)y >= (unsigned)H) return;
+        unsigned char &dst = buffer[x + (y >> 3) * W];
+        dst = Blend<Mode>::apply(dst, Blend<Mode>::solid(bit_mask[y & 7]), bit_mask[y & 7]);
+    }
+
+    template <LCD_COLOR Mode>
+    void hline(int y, int x1, int x2) const {
+        if ((unsigned)y >= (unsigned)H) return;
+        if (x1 > x2) swap(x1, x2);
+        if (x1 < 0) x1 = 0;
+        if (x2 >= W) x2 = W - 1;
+
+        unsigned char *row = buffer + (y >> 3) * W;
+        for (int x = x1; x <= x2; ++x)
+            apply<Mode>(row[x], bit_mask[y & 7]);
+    }
+
+    template <LCD_COLOR Mode>
+    void vline(int x, int y1, int y2) const {
+        if ((unsigned)x >= (unsigned)W) return;
+        if (y1 > y2) swap(y1, y2);
+        if (y1 < 0) y1 = 0;
+        if (y2 >= H) y2 = H - 1;
+        if (y1 > y2) return;
+
+        const int top = y1 >> 3, bottom = y2 >> 3;
+        unsigned char *column = buffer + x;
+        if (top == bottom) {
+            apply<Mode>(column[top * W], high_mask[y1 & 7] & low_mask[(y2 & 7) + 1]);
+            return;
+        }
+        apply<Mode>(column[top * W], high_mask[y1 & 7]);
+        for (int b = top + 1; b < bottom; ++b)
+            apply<Mode>(column[b * W], 0xFF);
+        apply<Mode>(column[bottom * W], low_mask[(y2 & 7) + 1]);
+    }
+
+    // inclusive corners, clipped once before the loops
+    template <LCD_COLOR Mode>
+    void fill_rect(int x1, int y1, int x2, int y2) const {
+        if (x1 > x2) swap(x1, x2);
+        if (y1 > y2) swap(y1, y2);
+        if (x1 < 0) x1 = 0;
+        if (y1 < 0) y1 = 0;
+        if (x2 >= W) x2 = W - 1;
+        if (y2 >= H) y2 = H - 1;
+        if (x1 > x2 || y1 > y2) return;
+
+        const int top = y1 >> 3, bottom = y2 >> 3;
+        for (int b = top; b <= bottom; ++b) {
+            unsigned char mask = 0xFF;
+            if (b == top) mask &= high_mask[y1 & 7];
+            if (b == bottom) mask &= low_mask[(y2 & 7) + 1];
+            const unsigned char src = Blend<Mode>::solid(mask);
+            unsigned char *row = buffer + b * W;
+            for (int x = x1; x <= x2; ++x)
+                row[x] = Blend<Mode>::apply(row[x], src, mask);
+        }
+    }
+
+    // Same semantics as LCD_Blit: source in LCD_Buffer layout, w bytes per
+    // bank row, (h + 7) / 8 bank rows, placed at any pixel offset.
+    template <LCD_COLOR Mode>
+    void blit(const unsigned char *source, int x1, int y1, int w, int h) const {
+        static_assert((Mode & MODE) >= XOR, "blits are XOR, OR or AND, possibly negated");
+        const int cx1 = x1 < 0 ? -x1 : 0;
+        const int cx2 = x1 + w > W ? W - x1 : w;
+        if (cx1 >= cx2 || h <= 0) return;
+
+        const int shift = y1 & 7; // y1 mod 8, also for negative y1
+        const int first = (y1 - shift) / 8; // floor(y1 / 8)
+        const int rows = (h + 7) / 8;
+
+        for (int sy = 0; sy < rows; ++sy) {
+            const unsigned char rowmask = sy == rows - 1 ? low_mask[h - sy * 8] : 0xFF;
+            const int b = first + sy;
+            const unsigned char *src = source + sy * w;
+            if (b >= 0 && b < banks) {
+                const unsigned char mask = (unsigned char)(rowmask << shift);
+                unsigned char *dst = buffer + b * W;
+                for (int x = cx1; x < cx2; ++x)
+                    dst[x1 + x] = Blend<Mode>::apply(dst[x1 + x], (unsigned char)((src[x] & rowmask) << shift), mask);
+            }
+            if (shift && b + 1 >= 0 && b + 1 < banks) {
+                const unsigned char mask = (unsigned char)(rowmask >> (8 - shift));
+                unsigned char *dst = buffer + (b + 1) * W;
+                for (int x = cx1; x < cx2; ++x)
+                    dst[x1 + x] = Blend<Mode>::apply(dst[x1 + x], (unsigned char)((src[x] & rowmask) >> (8 - shift)), mask);
+            }
+        }
+    }
+
+private:
+    template <LCD_COLOR Mode>
+    static void apply(unsigned char &dst, unsigned char mask) {
+        dst = Blend<Mode>::apply(dst, Blend<Mode>::solid(mask), mask);
+    }
+
+    static void swap(int &a, int &b) {
+        int t = a;
+        a = b;
+        b = t;
+    }
+
+    unsigned char *buffer;
+};
+
+typedef Surface<LCD_WIDTH, LCD_HEIGHT> Screen;
+
+// the current C drawing target (see LCD_SetTarget)
+inline Screen screen() {
+    return Screen(LCD_GetTarget());
+}
+
+}
+
+#endif
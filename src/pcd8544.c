@@ -0,0 +1,101 @@
+#include <string.h>
+#include "pcd8544.h"
+
+static LCD_PCD8544 *attached = NULL;
+
+void LCD_PCD8544Reset(LCD_PCD8544 *lcd, unsigned long clock_hz) {
+    memset(lcd, 0, sizeof(*lcd));
+    lcd->power_down = 1;
+    lcd->mode = LCD_PCD8544_BLANK;
+    lcd->clock_hz = clock_hz;
+    lcd->ended = 1;
+}
+
+// Addresses out of range are ignored, as are unknown commands. H selects the
+// instruction set, function set and NOP belong to both.
+static void command(LCD_PCD8544 *lcd, unsigned char byte) {
+    if ((byte & 0xF8) == 0x20) {
+        lcd->power_down = !!(byte & 0x04);
+        lcd->vertical = !!(byte & 0x02);
+        lcd->extended = byte & 0x01;
+    }
+    else if (lcd->extended) {
+        if (byte & 0x80) lcd->vop = byte & 0x7F;
+        else if ((byte & 0xF8) == 0x10) lcd->bias = byte & 0x07;
+        else if ((byte & 0xFC) == 0x04) lcd->temperature = byte & 0x03;
+    }
+    else if (byte & 0x80) {
+        if ((byte & 0x7F) < LCD_WIDTH) lcd->x = byte & 0x7F;
+    }
+    else if ((byte & 0xF8) == 0x40) {
+        if ((byte & 0x07) < LCD_HEIGHT / 8) lcd->y = byte & 0x07;
+    }
+    else if ((byte & 0xFA) == 0x08) lcd->mode = byte & 0x05;
+}
+
+// the address counter wraps to 0,0 after the last address in both modes
+static void data(LCD_PCD8544 *lcd, unsigned char byte) {
+    lcd->ram[lcd->x + lcd->y * LCD_WIDTH] = byte;
+    if (lcd->vertical) {
+        if (++lcd->y == LCD_HEIGHT / 8) {
+            lcd->y = 0;
+            if (++lcd->x == LCD_WIDTH) lcd->x = 0;
+        }
+    }
+    else if (++lcd->x == LCD_WIDTH) {
+        lcd->x = 0;
+        if (++lcd->y == LCD_HEIGHT / 8) lcd->y = 0;
+    }
+}
+
+void LCD_PCD8544Write(LCD_PCD8544 *lcd, LCD_BUS type, unsigned char byte) {
+    unsigned long long ns;
+    if (type == LCD_BUS_END) {
+        if (!lcd->ended) ++lcd->transfers;
+        lcd->ended = 1;
+        return;
+    }
+    if (lcd->ended) {
+        lcd->transfer_ns = 0;
+        lcd->ended = 0;
+    }
+
+    // 8 clock periods per byte
+    ns = lcd->clock_hz ? 8000000000ULL / lcd->clock_hz : 0;
+    lcd->transfer_ns += ns;
+    lcd->bus_ns += ns;
+
+    if (type == LCD_BUS_COMMAND) {
+        command(lcd, byte);
+        ++lcd->commands;
+    }
+    else {
+        data(lcd, byte);
+        ++lcd->data;
+    }
+}
+
+void LCD_PCD8544Show(const LCD_PCD8544 *lcd, unsigned char *screen) {
+    size_t i;
+    if (lcd->power_down || lcd->mode == LCD_PCD8544_BLANK) {
+        memset(screen, 0x00, sizeof(LCD_Buffer));
+    }
+    else if (lcd->mode == LCD_PCD8544_ALL_ON) {
+        memset(screen, 0xFF, sizeof(LCD_Buffer));
+    }
+    else if (lcd->mode == LCD_PCD8544_INVERSE) {
+        for (i = 0; i < sizeof(LCD_Buffer); ++i) {
+            screen[i] = ~lcd->ram[i];
+        }
+    }
+    else memcpy(screen, lcd->ram, sizeof(LCD_Buffer));
+}
+
+static void attached_write(LCD_BUS type, unsigned char byte) {
+    LCD_PCD8544Write(attached, type, byte);
+}
+
+void LCD_PCD8544Attach(LCD_PCD8544 *lcd) {
+    attached = lcd;
+    LCD_SetBusHook(lcd ? attached_write : NULL);
+}
@@ -0,0 +1,50 @@
+#ifndef PCD8544_H
+#define PCD8544_H
+
+#include "lcd.h"
+
+// Simulation of the PCD8544 controller from the bytes it is sent: display RAM,
+// address counter, horizontal and vertical addressing, power-down, display
+// modes and the extended instruction set, plus the time the bytes take on the
+// bus at a given SPI clock. The emulated backend shows the panel through it,
+// so partial updates and address changes look as on the device, and other
+// builds can attach one to the bus hook to check or time their transmissions.
+
+// display control, D and E bits
+typedef enum {
+    LCD_PCD8544_BLANK = 0,
+    LCD_PCD8544_ALL_ON = 1,
+    LCD_PCD8544_NORMAL = 4,
+    LCD_PCD8544_INVERSE = 5
+} LCD_PCD8544_MODE;
+
+typedef struct {
+    LCD_Buffer ram;
+    unsigned char x, y; // address counter
+    unsigned char power_down, vertical, extended; // function set bits
+    unsigned char mode; // LCD_PCD8544_MODE
+    unsigned char vop, bias, temperature; // extended instruction set
+    unsigned long clock_hz; // SPI clock, the PCD8544 accepts up to 4 MHz
+    unsigned long commands, data; // bytes received since reset
+    unsigned long transfers; // transmissions ended since reset
+    unsigned long long bus_ns; // time on the bus since reset
+    unsigned long long transfer_ns; // time on the bus of the current or last transmission
+    int ended; // the next byte starts a transmission
+} LCD_PCD8544;
+
+// state after a reset pulse: powered down, blank, registers cleared
+void LCD_PCD8544Reset(LCD_PCD8544 *lcd, unsigned long clock_hz);
+void LCD_PCD8544Write(LCD_PCD8544 *lcd, LCD_BUS type, unsigned char byte);
+
+// what the panel shows, in LCD_Buffer layout
+void LCD_PCD8544Show(const LCD_PCD8544 *lcd, unsigned char *screen);
+
+// feeds lcd with the bytes sent from now on, replacing the bus hook; NULL detaches
+void LCD_PCD8544Attach(LCD_PCD8544 *lcd);
+
+#ifdef LCD_EMULATED
+// the controller behind the emulated display
+const LCD_PCD8544 *LCD_EmulatedPanel();
+#endif
+
+#endif
@@ -0,0 +1,142 @@
+#include <string.h>
+#include "points.h"
+
+// points are processed by chunks small enough to stay on the stack
+#define CHUNK 128
+
+// batches this large are first merged into a mask plane
+#define PLANE_THRESHOLD 64
+
+#define SIZE (LCD_WIDTH * LCD_HEIGHT / 8)
+
+typedef struct {
+    unsigned short offset[CHUNK];
+    unsigned char bit[CHUNK];
+} Chunk;
+
+// clip rectangle and origin, resolved once per call
+typedef struct {
+    int x1, y1;
+    unsigned w, h;
+    int ox, oy;
+} Window;
+
+static void window(Window *win) {
+    int x2, y2;
+    LCD_GetClip(&win->x1, &win->y1, &x2, &y2);
+    LCD_GetOrigin(&win->ox, &win->oy);
+    win->w = x2 < win->x1 ? 0 : x2 - win->x1 + 1;
+    win->h = y2 < win->y1 ? 0 : y2 - win->y1 + 1;
+}
+
+// Branch-free clipping and addressing. Clipped points get an empty bit mask,
+// which leaves their byte unchanged whatever the color.
+static void address(Chunk *chunk, const Window *win, const short *x, const short *y,
+                    int stride, int n) {
+    int i, px, py, inside;
+    for (i = 0; i < n; ++i) {
+        px = x[i * stride];
+        py = y[i * stride];
+        inside = ((unsigned)(px - win->x1) < win->w) & ((unsigned)(py - win->y1) < win->h);
+        px += win->ox;
+        py += win->oy;
+        chunk->offset[i] = inside ? px + (py >> 3) * LCD_WIDTH : 0;
+        chunk->bit[i] = inside << (py & 7);
+    }
+}
+
+static void apply(unsigned char *buffer, const Chunk *chunk, int n, LCD_COLOR color) {
+    int i;
+    switch (color) {
+    case WHITE:
+        for (i = 0; i < n; ++i) buffer[chunk->offset[i]] &= ~chunk->bit[i];
+        break;
+    case BLACK:
+        for (i = 0; i < n; ++i) buffer[chunk->offset[i]] |= chunk->bit[i];
+        break;
+    case XOR:
+        for (i = 0; i < n; ++i) buffer[chunk->offset[i]] ^= chunk->bit[i];
+        break;
+    default:
+        break;
+    }
+}
+
+// Large batches are accumulated in a plane of the screen size, in bank order,
+// then combined with the target in a single pass. For WHITE and BLACK the
+// plane holds which pixels are touched; for XOR it holds the parity of the
+// number of hits, so the result matches plotting the points one by one.
+static void plot(const short *x, const short *y, int stride, int n, LCD_COLOR color) {
+    unsigned char plane[SIZE];
+    unsigned char *buffer = LCD_GetTarget();
+    Window win;
+    Chunk chunk;
+    int i, count;
+
+    if (color != WHITE && color != BLACK && color != XOR) return;
+    window(&win);
+
+    if (n < PLANE_THRESHOLD) {
+        address(&chunk, &win, x, y, stride, n);
+        apply(buffer, &chunk, n, color);
+        return;
+    }
+
+    memset(plane, 0, sizeof(plane));
+    for (i = 0; i < n; i += CHUNK) {
+        count = n - i < CHUNK ? n - i : CHUNK;
+        address(&chunk, &win, x + i * stride, y + i * stride, stride, count);
+        apply(plane, &chunk, count, color == XOR ? XOR : BLACK);
+    }
+
+    switch (color) {
+    case WHITE:
+        for (i = 0; i < SIZE; ++i) buffer[i] &= ~plane[i];
+        break;
+    case BLACK:
+        for (i = 0; i < SIZE; ++i) buffer[i] |= plane[i];
+        break;
+    default:
+        for (i = 0; i < SIZE; ++i) buffer[i] ^= plane[i];
+        break;
+    }
+}
+
+void LCD_PlotPoints(const LCD_Point *points, int n, LCD_COLOR color) {
+    if (n <= 0) return;
+    plot(&points->x, &points->y, sizeof(LCD_Point) / sizeof(short), n, color);
+}
+
+void LCD_PlotPointsSoA(const short *x, const short *y, int n, LCD_COLOR color) {
+    if (n <= 0) return;
+    plot(x, y, 1, n, color);
+}
+
+void LCD_MovePoints(const LCD_Point *from, const LCD_Point *to, int n) {
+    unsigned char plane[SIZE];
+    unsigned char *buffer = LCD_GetTarget();
+    Window win;
+    Chunk chunk;
+    LCD_Point moved[2 * CHUNK];
+    int i, j, count, dirty = 0;
+
+    window(&win);
+    memset(plane, 0, sizeof(plane));
+    for (i = 0; i < n; i += CHUNK) {
+        count = 0;
+        for (j = i; j < n && j < i + CHUNK; ++j) {
+            if (from[j].x == to[j].x && from[j].y == to[j].y) continue;
+            moved[count++] = from[j];
+            moved[count++] = to[j];
+        }
+        if (!count) continue;
+        dirty = 1;
+        for (j = 0; j < count; j += CHUNK) {
+            address(&chunk, &win, &moved[j].x, &moved[j].y, sizeof(LCD_Point) / sizeof(short),
+                    count - j < CHUNK ? count - j : CHUNK);
+            apply(plane, &chunk, count - j < CHUNK ? count - j : CHUNK, XOR);
+        }
+    }
+    if (!dirty) return;
+    for (i = 0; i < SIZE; ++i) buffer[i] ^= plane[i];
+}
@@ -0,0 +1,23 @@
+#ifndef POINTS_H
+#define POINTS_H
+
+#include "lcd.h"
+
+// Batched pixel plotting, for scatter plots and particle systems.
+// The whole batch is clipped and turned into buffer offsets and bit masks in
+// branch-free passes, then applied with one loop per color instead of one
+// bounds check and color switch per point.
+
+typedef struct {
+    short x, y;
+} LCD_Point;
+
+// same result as calling LCD_Pixel on every point, in order
+void LCD_PlotPoints(const LCD_Point *points, int n, LCD_COLOR color);
+void LCD_PlotPointsSoA(const short *x, const short *y, int n, LCD_COLOR color);
+
+// moves points previously drawn in XOR mode from their old to their new
+// position, only touching the points that actually moved
+void LCD_MovePoints(const LCD_Point *from, const LCD_Point *to, int n);
+
+#endif
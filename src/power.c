@@ -0,0 +1,87 @@
+#include <string.h>
+#include <time.h>
+#include "power.h"
+
+static LCD_POWER_STATE state = LCD_POWER_ACTIVE;
+static unsigned long long idle_us = 0;
+static unsigned long long last_change = 0, state_start = 0;
+static LCD_PowerStats stats;
+
+// last frame sent, to detect unchanged frames
+static LCD_Buffer shown;
+static int shown_valid = 0;
+
+static unsigned long long now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+// the screen buffer, whatever the drawing target of the calling thread
+static unsigned char *screen() {
+    unsigned char *target = LCD_GetTarget(), *buffer;
+    LCD_SetTarget(NULL);
+    buffer = LCD_GetTarget();
+    LCD_SetTarget(target);
+    return buffer;
+}
+
+static void enter(LCD_POWER_STATE next, unsigned long long now) {
+    stats.time_us[state] += now - state_start;
+    state_start = now;
+    state = next;
+}
+
+static void send(const unsigned char *buffer, unsigned long long now) {
+    if (state == LCD_POWER_DOWN) {
+        LCD_SetPowerDown(0);
+        ++stats.wakes;
+    }
+    LCD_Display();
+    memcpy(shown, buffer, sizeof(shown));
+    shown_valid = 1;
+    ++stats.sent;
+    last_change = now;
+    enter(LCD_POWER_ACTIVE, now);
+}
+
+void LCD_PowerInit(unsigned long idle_ms) {
+    idle_us = idle_ms * 1000ULL;
+    memset(&stats, 0, sizeof(stats));
+    shown_valid = 0;
+    state = LCD_POWER_ACTIVE;
+    last_change = state_start = now_us();
+}
+
+LCD_POWER_STATE LCD_PowerDisplay() {
+    unsigned char *buffer = screen();
+    unsigned long long now = now_us();
+
+    if (!shown_valid || memcmp(shown, buffer, sizeof(shown))) {
+        send(buffer, now);
+        return state;
+    }
+
+    ++stats.skipped;
+    if (state == LCD_POWER_ACTIVE) enter(LCD_POWER_IDLE, now);
+    if (state == LCD_POWER_IDLE && idle_us && now - last_change >= idle_us) {
+        LCD_SetPowerDown(1);
+        enter(LCD_POWER_DOWN, now);
+    }
+    return state;
+}
+
+void LCD_PowerWake() {
+    unsigned long long now = now_us();
+    if (state == LCD_POWER_DOWN) send(screen(), now);
+    else last_change = now;
+}
+
+LCD_POWER_STATE LCD_PowerState() {
+    return state;
+}
+
+void LCD_PowerGetStats(LCD_PowerStats *out) {
+    *out = stats;
+    out->time_us[state] += now_us() - state_start;
+}
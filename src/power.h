@@ -0,0 +1,37 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include "lcd.h"
+
+// Power management for battery powered displays. LCD_PowerDisplay replaces
+// LCD_Display in the frame loop: frames equal to the last one sent cause no
+// bus traffic, and once the screen has not changed for the idle timeout the
+// controller is put in power-down. The next change, or LCD_PowerWake, wakes it
+// up with a single command and resends the frame.
+
+typedef enum {
+    LCD_POWER_ACTIVE = 0, // frames are sent
+    LCD_POWER_IDLE, // unchanged frames, the bus is quiet
+    LCD_POWER_DOWN, // controller in power-down, panel blank
+    LCD_POWER_STATES
+} LCD_POWER_STATE;
+
+typedef struct {
+    unsigned long long time_us[LCD_POWER_STATES]; // time spent in each state
+    unsigned long sent; // frames sent
+    unsigned long skipped; // unchanged frames
+    unsigned long wakes; // power-downs left
+} LCD_PowerStats;
+
+// idle timeout before power-down in milliseconds, 0 to never power down
+void LCD_PowerInit(unsigned long idle_ms);
+LCD_POWER_STATE LCD_PowerDisplay();
+
+// shows the screen again and restarts the idle timeout, e.g. on a key press
+void LCD_PowerWake();
+LCD_POWER_STATE LCD_PowerState();
+
+// statistics since LCD_PowerInit, including the time in the current state
+void LCD_PowerGetStats(LCD_PowerStats *stats);
+
+#endif
@@ -0,0 +1,400 @@
+#include <string.h>
+#include "reference.h"
+#include "transform.h"
+
+// clip rectangle in drawing coordinates, and the origin
+typedef struct {
+    int x1, y1, x2, y2;
+    int ox, oy;
+} Window;
+
+static Window window() {
+    Window w;
+    LCD_GetClip(&w.x1, &w.y1, &w.x2, &w.y2);
+    LCD_GetOrigin(&w.ox, &w.oy);
+    return w;
+}
+
+static int get(const unsigned char *buffer, int x, int y) {
+    return (buffer[x + y / 8 * LCD_WIDTH] >> (y % 8)) & 1;
+}
+
+static void set(unsigned char *buffer, int x, int y, int on) {
+    if (on) buffer[x + y / 8 * LCD_WIDTH] |= 1 << (y % 8);
+    else buffer[x + y / 8 * LCD_WIDTH] &= ~(1 << (y % 8));
+}
+
+// WHITE, BLACK and XOR change the pixel, other colors leave it
+static void plot(const Window *w, int x, int y, LCD_COLOR color) {
+    unsigned char *buffer = LCD_GetTarget();
+    if (x < w->x1 || x > w->x2 || y < w->y1 || y > w->y2) return;
+    x += w->ox;
+    y += w->oy;
+    if (color == WHITE) set(buffer, x, y, 0);
+    else if (color == BLACK) set(buffer, x, y, 1);
+    else if (color == XOR) set(buffer, x, y, !get(buffer, x, y));
+}
+
+static void sort(int *a, int *b) {
+    int t;
+    if (*a > *b) {
+        t = *a;
+        *a = *b;
+        *b = t;
+    }
+}
+
+// every pixel of the clip rectangle inside x1..x2, y1..y2
+static void fill(const Window *w, int x1, int y1, int x2, int y2, LCD_COLOR color) {
+    int x, y;
+    for (y = w->y1; y <= w->y2; ++y) {
+        for (x = w->x1; x <= w->x2; ++x) {
+            if (x >= x1 && x <= x2 && y >= y1 && y <= y2) plot(w, x, y, color);
+        }
+    }
+}
+
+void LCD_RefClear() {
+    Window w = window();
+    fill(&w, w.x1, w.y1, w.x2, w.y2, WHITE);
+}
+
+void LCD_RefInvert() {
+    Window w = window();
+    fill(&w, w.x1, w.y1, w.x2, w.y2, XOR);
+}
+
+void LCD_RefPixel(int x, int y, LCD_COLOR color) {
+    Window w = window();
+    plot(&w, x, y, color);
+}
+
+// Bresenham from the first end, which is plotted, to the pixel before the
+// second one, which is not
+void LCD_RefDrawLine(int x1, int y1, int x2, int y2, LCD_COLOR color) {
+    Window w = window();
+    int i, dx = x2 - x1, dy = y2 - y1;
+    int sx = dx < 0 ? -1 : 1, sy = dy < 0 ? -1 : 1;
+    int major, minor, cumul, x = x1, y = y1;
+    dx = dx < 0 ? -dx : dx;
+    dy = dy < 0 ? -dy : dy;
+    major = dx > dy ? dx : dy;
+    minor = dx > dy ? dy : dx;
+    cumul = major / 2;
+    plot(&w, x, y, color);
+    for (i = 1; i < major; ++i) {
+        cumul += minor;
+        if (dx > dy) x += sx;
+        else y += sy;
+        if (cumul > major) {
+            cumul -= major;
+            if (dx > dy) y += sy;
+            else x += sx;
+        }
+        plot(&w, x, y, color);
+    }
+}
+
+void LCD_RefHorizontalLine(int y, int x1, int x2, LCD_COLOR color) {
+    Window w = window();
+    sort(&x1, &x2);
+    fill(&w, x1, y, x2, y, color);
+}
+
+void LCD_RefVerticalLine(int x, int y1, int y2, LCD_COLOR color) {
+    Window w = window();
+    sort(&y1, &y2);
+    fill(&w, x, y1, x, y2, color);
+}
+
+void LCD_RefFillRect(int x1, int y1, int x2, int y2, LCD_COLOR color) {
+    Window w = window();
+    sort(&x1, &x2);
+    sort(&y1, &y2);
+    fill(&w, x1, y1, x2, y2, color);
+}
+
+// every pixel of the border once
+void LCD_RefDrawRect(int x1, int y1, int x2, int y2, LCD_COLOR color) {
+    Window w = window();
+    int x, y;
+    sort(&x1, &x2);
+    sort(&y1, &y2);
+    for (y = w.y1; y <= w.y2; ++y) {
+        for (x = w.x1; x <= w.x2; ++x) {
+            if (x < x1 || x > x2 || y < y1 || y > y2) continue;
+            if (x == x1 || x == x2 || y == y1 || y == y2) plot(&w, x, y, color);
+        }
+    }
+}
+
+#ifndef LCD_NO_CIRCLES
+
+// The outline of a circle is the midpoint walk over one octant, (a, b) with
+// a <= b, mirrored 8 ways. Returns the largest |dy| among the outline pixels
+// of column |dx| = column, or -1 when the column has none; sets on when
+// (column, row) is one of them.
+static int outline(int radius, int column, int row, int *on) {
+    int a = 0, b = radius, d = 1 - radius, top = -1;
+    column = column < 0 ? -column : column;
+    row = row < 0 ? -row : row;
+    *on = 0;
+    while (b >= a) {
+        if (a == column && b > top) top = b;
+        if (b == column && a > top) top = a;
+        if ((a == column && b == row) || (b == column && a == row)) *on = 1;
+        if (d < 0) d += 2 * a + 3;
+        else {
+            d += 2 * (a - b) + 5;
+            --b;
+        }
+        ++a;
+    }
+    return top;
+}
+
+void LCD_RefDrawCircle(int x, int y, int radius, LCD_COLOR color) {
+    Window w = window();
+    int px, py, on;
+    if (radius < 0) return;
+    for (py = w.y1; py <= w.y2; ++py) {
+        for (px = w.x1; px <= w.x2; ++px) {
+            if (px < x - radius || px > x + radius || py < y - radius || py > y + radius) continue;
+            outline(radius, px - x, py - y, &on);
+            if (on) plot(&w, px, py, color);
+        }
+    }
+}
+
+// each column is filled between the top and bottom pixels of the outline
+void LCD_RefFillCircle(int x, int y, int radius, LCD_COLOR color) {
+    Window w = window();
+    int px, py, top, on;
+    if (radius < 0) return;
+    for (px = w.x1; px <= w.x2; ++px) {
+        if (px < x - radius || px > x + radius) continue;
+        top = outline(radius, px - x, 0, &on);
+        for (py = w.y1; py <= w.y2; ++py) {
+            if (py >= y - top && py <= y + top) plot(&w, px, py, color);
+        }
+    }
+}
+
+#endif
+
+// Source pixels outside of the rows of h are ignored. The mode combines the
+// source pixel with the target one, then NOT inverts the result.
+void LCD_RefBlit(const unsigned char *buffer, int x1, int y1, int w, int h, LCD_COLOR mode) {
+    Window win = window();
+    unsigned char *target = LCD_GetTarget();
+    int x, y, tx, ty, s, d;
+#ifdef LCD_NO_BLIT_MODES
+    mode = OR;
+#endif
+    for (y = win.y1; y <= win.y2; ++y) {
+        for (x = win.x1; x <= win.x2; ++x) {
+            if (x < x1 || x >= x1 + w || y < y1 || y >= y1 + h) continue;
+            s = (buffer[(x - x1) + (y - y1) / 8 * w] >> ((y - y1) % 8)) & 1;
+            tx = x + win.ox;
+            ty = y + win.oy;
+            d = get(target, tx, ty);
+            switch (mode & MODE) {
+            case OR:
+                d |= s;
+                break;
+            case AND:
+                d &= s;
+                break;
+            case XOR:
+                d ^= s;
+                break;
+            default:
+                break;
+            }
+            if (mode & NOT) d = !d;
+            set(target, tx, ty, d);
+        }
+    }
+}
+
+// the clip rectangle moves by x, y within itself, uncovering blank pixels
+void LCD_RefScroll(int x, int y) {
+    Window w = window();
+    unsigned char *target = LCD_GetTarget();
+    LCD_Buffer before;
+    int px, py, sx, sy;
+    memcpy(before, target, sizeof(before));
+    for (py = w.y1; py <= w.y2; ++py) {
+        for (px = w.x1; px <= w.x2; ++px) {
+            sx = px - x;
+            sy = py - y;
+            set(target, px + w.ox, py + w.oy, sx >= w.x1 && sx <= w.x2 && sy >= w.y1 && sy <= w.y2 &&
+                get(before, sx + w.ox, sy + w.oy));
+        }
+    }
+}
+
+// A shape is a box with elliptical corners of radii (rx, ry), see shape.c.
+// A pixel is inside when it is inside the box and, in the corners, inside the
+// ellipse: dx^2 / (rx + 1/2)^2 + dy^2 / (ry + 1/2)^2 <= 1, where dx and dy are
+// its distances from the straight part of the box.
+typedef struct {
+    int x1, y1, x2, y2;
+    int rx, ry;
+} Shape;
+
+// start and end directions in doubled coordinates, around the box center
+typedef struct {
+    int full, wide;
+    long long sx, sy, ex, ey;
+    long long cx2, cy2;
+} Sector;
+
+static Shape make_shape(int x1, int y1, int x2, int y2, int rx, int ry) {
+    Shape s;
+    sort(&x1, &x2);
+    sort(&y1, &y2);
+    if (rx < 0) rx = 0;
+    if (ry < 0) ry = 0;
+    if (rx > (x2 - x1) / 2) rx = (x2 - x1) / 2;
+    if (ry > (y2 - y1) / 2) ry = (y2 - y1) / 2;
+    s.x1 = x1;
+    s.y1 = y1;
+    s.x2 = x2;
+    s.y2 = y2;
+    s.rx = rx;
+    s.ry = ry;
+    return s;
+}
+
+static int inside(const Shape *s, int x, int y) {
+    long long a = 2 * s->rx + 1, b = 2 * s->ry + 1, dx = 0, dy = 0;
+    if (x < s->x1 || x > s->x2 || y < s->y1 || y > s->y2) return 0;
+    if (x < s->x1 + s->rx) dx = s->x1 + s->rx - x;
+    else if (x > s->x2 - s->rx) dx = x - (s->x2 - s->rx);
+    if (y < s->y1 + s->ry) dy = s->y1 + s->ry - y;
+    else if (y > s->y2 - s->ry) dy = y - (s->y2 - s->ry);
+    return 4 * a * a * dy * dy <= b * b * (a * a - 4 * dx * dx);
+}
+
+// inside, with at least one 4-neighbour outside
+static int on_outline(const Shape *s, int x, int y) {
+    return inside(s, x, y) && (!inside(s, x - 1, y) || !inside(s, x + 1, y) ||
+                               !inside(s, x, y - 1) || !inside(s, x, y + 1));
+}
+
+// inside, but not inside the shape inset by width
+static int on_stroke(const Shape *s, int width, int x, int y) {
+    Shape inner;
+    if (width <= 1) return on_outline(s, x, y);
+    inner.x1 = s->x1 + width;
+    inner.y1 = s->y1 + width;
+    inner.x2 = s->x2 - width;
+    inner.y2 = s->y2 - width;
+    inner.rx = s->rx > width ? s->rx - width : 0;
+    inner.ry = s->ry > width ? s->ry - width : 0;
+    return inside(s, x, y) && !inside(&inner, x, y);
+}
+
+static Sector make_sector(const Shape *s, int start, int end) {
+    Sector sector;
+    int sweep = (end - start) % 360;
+    int rx = s->rx ? s->rx : 1, ry = s->ry ? s->ry : 1;
+    if (sweep < 0) sweep += 360;
+    sector.full = sweep == 0 && end != start;
+    sector.wide = sweep > 180;
+    sector.sx = (long long)rx * LCD_Cos(start);
+    sector.sy = (long long)ry * LCD_Sin(start);
+    sector.ex = (long long)rx * LCD_Cos(end);
+    sector.ey = (long long)ry * LCD_Sin(end);
+    sector.cx2 = s->x1 + s->x2;
+    sector.cy2 = s->y1 + s->y2;
+    return sector;
+}
+
+// Between the start and end directions counter-clockwise, both included.
+// Over 180 degrees, anything not strictly between end and start.
+static int in_sector(const Sector *sector, int x, int y) {
+    long long px = 2LL * x - sector->cx2, py = sector->cy2 - 2LL * y;
+    long long start = sector->sx * py - sector->sy * px; // cross(S, P)
+    long long end = px * sector->ey - py * sector->ex;   // cross(P, E)
+    if (sector->full) return 1;
+    if (!sector->wide) return start >= 0 && end >= 0;
+    return !(start < 0 && end < 0);
+}
+
+typedef enum {
+    SHAPE_OUTLINE,
+    SHAPE_FILL,
+    SHAPE_STROKE
+} SHAPE_STYLE;
+
+static void shape(const Shape *s, SHAPE_STYLE style, int width, const Sector *sector, LCD_COLOR color) {
+    Window w = window();
+    int x, y, on;
+    for (y = w.y1; y <= w.y2; ++y) {
+        for (x = w.x1; x <= w.x2; ++x) {
+            if (style == SHAPE_OUTLINE) on = on_outline(s, x, y);
+            else if (style == SHAPE_FILL) on = inside(s, x, y);
+            else on = on_stroke(s, width, x, y);
+            if (on && (!sector || in_sector(sector, x, y))) plot(&w, x, y, color);
+        }
+    }
+}
+
+static void ellipse(int x, int y, int rx, int ry, SHAPE_STYLE style, int width,
+                    int arc, int start, int end, LCD_COLOR color) {
+    Shape s;
+    Sector sector;
+    if (rx < 0 || ry < 0) return;
+    s = make_shape(x - rx, y - ry, x + rx, y + ry, rx, ry);
+    if (arc) sector = make_sector(&s, start, end);
+    shape(&s, style, width, arc ? &sector : NULL, color);
+}
+
+void LCD_RefDrawEllipse(int x, int y, int rx, int ry, LCD_COLOR color) {
+    ellipse(x, y, rx, ry, SHAPE_OUTLINE, 1, 0, 0, 0, color);
+}
+
+void LCD_RefFillEllipse(int x, int y, int rx, int ry, LCD_COLOR color) {
+    ellipse(x, y, rx, ry, SHAPE_FILL, 1, 0, 0, 0, color);
+}
+
+void LCD_RefStrokeEllipse(int x, int y, int rx, int ry, int width, LCD_COLOR color) {
+    ellipse(x, y, rx, ry, SHAPE_STROKE, width, 0, 0, 0, color);
+}
+
+void LCD_RefStrokeCircle(int x, int y, int radius, int width, LCD_COLOR color) {
+    ellipse(x, y, radius, radius, SHAPE_STROKE, width, 0, 0, 0, color);
+}
+
+void LCD_RefDrawArc(int x, int y, int rx, int ry, int start, int end, LCD_COLOR color) {
+    ellipse(x, y, rx, ry, SHAPE_OUTLINE, 1, 1, start, end, color);
+}
+
+void LCD_RefStrokeArc(int x, int y, int rx, int ry, int start, int end, int width, LCD_COLOR color) {
+    ellipse(x, y, rx, ry, SHAPE_STROKE, width, 1, start, end, color);
+}
+
+void LCD_RefFillPie(int x, int y, int rx, int ry, int start, int end, LCD_COLOR color) {
+    ellipse(x, y, rx, ry, SHAPE_FILL, 1, 1, start, end, color);
+}
+
+void LCD_RefDrawRoundRect(int x1, int y1, int x2, int y2, int radius, LCD_COLOR color) {
+    Shape s = make_shape(x1, y1, x2, y2, radius, radius);
+    shape(&s, SHAPE_OUTLINE, 1, NULL, color);
+}
+
+void LCD_RefFillRoundRect(int x1, int y1, int x2, int y2, int radius, LCD_COLOR color) {
+    Shape s = make_shape(x1, y1, x2, y2, radius, radius);
+    shape(&s, SHAPE_FILL, 1, NULL, color);
+}
+
+void LCD_RefStrokeRoundRect(int x1, int y1, int x2, int y2, int radius, int width, LCD_COLOR color) {
+    Shape s = make_shape(x1, y1, x2, y2, radius, radius);
+    shape(&s, SHAPE_STROKE, width, NULL, color);
+}
+
+void LCD_RefStrokeRect(int x1, int y1, int x2, int y2, int width, LCD_COLOR color) {
+    LCD_RefStrokeRoundRect(x1, y1, x2, y2, 0, width, color);
+}
@@ -0,0 +1,52 @@
+#ifndef REFERENCE_H
+#define REFERENCE_H
+
+#include "lcd.h"
+
+// Reference implementations of the lcd.h and shape.h primitives, written for
+// obviousness rather than speed: each one decides, pixel by pixel over the
+// clip rectangle, whether the pixel is covered, and blends it alone. They draw
+// on the target of the calling thread with its clip rectangle and origin, like
+// the primitives, and must leave exactly the same frame. The fuzz example
+// checks that on random inputs, the bench example measures what the
+// primitives gain.
+//
+// Whole screen targets only: bank row targets (LCD_SetTargetRows) are not
+// supported.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void LCD_RefClear();
+void LCD_RefInvert();
+void LCD_RefPixel(int x, int y, LCD_COLOR color);
+void LCD_RefDrawLine(int x1, int y1, int x2, int y2, LCD_COLOR color);
+void LCD_RefHorizontalLine(int y, int x1, int x2, LCD_COLOR color);
+void LCD_RefVerticalLine(int x, int y1, int y2, LCD_COLOR color);
+void LCD_RefFillRect(int x1, int y1, int x2, int y2, LCD_COLOR color);
+void LCD_RefDrawRect(int x1, int y1, int x2, int y2, LCD_COLOR color);
+#ifndef LCD_NO_CIRCLES
+void LCD_RefDrawCircle(int x, int y, int radius, LCD_COLOR color);
+void LCD_RefFillCircle(int x, int y, int radius, LCD_COLOR color);
+#endif
+void LCD_RefBlit(const unsigned char *buffer, int x1, int y1, int w, int h, LCD_COLOR mode);
+void LCD_RefScroll(int x, int y);
+
+void LCD_RefDrawEllipse(int x, int y, int rx, int ry, LCD_COLOR color);
+void LCD_RefFillEllipse(int x, int y, int rx, int ry, LCD_COLOR color);
+void LCD_RefStrokeEllipse(int x, int y, int rx, int ry, int width, LCD_COLOR color);
+void LCD_RefStrokeCircle(int x, int y, int radius, int width, LCD_COLOR color);
+void LCD_RefDrawArc(int x, int y, int rx, int ry, int start, int end, LCD_COLOR color);
+void LCD_RefStrokeArc(int x, int y, int rx, int ry, int start, int end, int width, LCD_COLOR color);
+void LCD_RefFillPie(int x, int y, int rx, int ry, int start, int end, LCD_COLOR color);
+void LCD_RefDrawRoundRect(int x1, int y1, int x2, int y2, int radius, LCD_COLOR color);
+void LCD_RefFillRoundRect(int x1, int y1, int x2, int y2, int radius, LCD_COLOR color);
+void LCD_RefStrokeRoundRect(int x1, int y1, int x2, int y2, int radius, int width, LCD_COLOR color);
+void LCD_RefStrokeRect(int x1, int y1, int x2, int y2, int width, LCD_COLOR color);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
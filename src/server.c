@@ -0,0 +1,358 @@
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "server.h"
+
+#define LCD_BANKS (LCD_HEIGHT / 8)
+#define SERVER_MAGIC 0x4C434431
+
+// damage of a bank row is a column range packed as (first << 8 | last)
+#define NO_DAMAGE 0xFF00u
+#define DAMAGE(lo, hi) ((unsigned int)(lo) << 8 | (unsigned int)(hi))
+#define DAMAGE_LO(d) ((int)((d) >> 8))
+#define DAMAGE_HI(d) ((int)((d) & 0xFF))
+
+typedef enum {
+    SLOT_FREE = 0,
+    SLOT_CLAIMED = 1,
+    SLOT_ACTIVE = 2,
+    SLOT_PENDING = 3 // rectangle published, checking for overlaps
+} SLOT_STATE;
+
+typedef struct {
+    unsigned int state;
+    unsigned int generation; // bumped by every client taking the slot
+    int x1, y1, x2, y2;
+    unsigned int damage[LCD_BANKS];
+    LCD_Buffer surface;
+} Slot;
+
+// layout of the shared memory object
+typedef struct {
+    unsigned int magic;
+    unsigned int doorbell; // futex word, bumped on every commit
+    Slot slots[LCD_SERVER_MAX_CLIENTS];
+} Shared;
+
+struct LCD_Server {
+    Shared *shared;
+    char name[64];
+    unsigned int doorbell;
+    unsigned char *screen;
+    // regions currently shown, to blank them when their client leaves
+    int active[LCD_SERVER_MAX_CLIENTS];
+    unsigned int generation[LCD_SERVER_MAX_CLIENTS];
+    int x1[LCD_SERVER_MAX_CLIENTS], y1[LCD_SERVER_MAX_CLIENTS];
+    int x2[LCD_SERVER_MAX_CLIENTS], y2[LCD_SERVER_MAX_CLIENTS];
+};
+
+struct LCD_Client {
+    Shared *shared;
+    Slot *slot;
+};
+
+static void futex_wait(unsigned int *word, unsigned int value, int timeout_ms) {
+    struct timespec ts, *timeout = NULL;
+    if (timeout_ms >= 0) {
+        ts.tv_sec = timeout_ms / 1000;
+        ts.tv_nsec = (timeout_ms % 1000) * 1000000L;
+        timeout = &ts;
+    }
+    syscall(SYS_futex, word, FUTEX_WAIT, value, timeout, NULL, 0);
+}
+
+static void futex_wake(unsigned int *word) {
+    syscall(SYS_futex, word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+static Shared *map_shared(const char *name, int create) {
+    Shared *shared;
+    int fd = shm_open(name, create ? O_CREAT | O_RDWR : O_RDWR, 0666);
+    if (fd < 0) return NULL;
+    if (create && ftruncate(fd, sizeof(Shared)) != 0) {
+        close(fd);
+        return NULL;
+    }
+    shared = mmap(NULL, sizeof(Shared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    return shared == MAP_FAILED ? NULL : shared;
+}
+
+static void merge_damage(unsigned int *damage, int lo, int hi) {
+    unsigned int old = __atomic_load_n(damage, __ATOMIC_RELAXED), merged;
+    do {
+        merged = DAMAGE(DAMAGE_LO(old) < lo ? DAMAGE_LO(old) : lo,
+                        DAMAGE_HI(old) > hi ? DAMAGE_HI(old) : hi);
+    } while (!__atomic_compare_exchange_n(damage, &old, merged, 1,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+// bits of bank row b covered by rows y1..y2
+static unsigned char bank_mask(int b, int y1, int y2) {
+    int top = y1 - b * 8, bottom = y2 - b * 8;
+    if (top < 0) top = 0;
+    if (bottom > 7) bottom = 7;
+    if (top > bottom) return 0;
+    return (0xFF << top) & (0xFF >> (7 - bottom));
+}
+
+LCD_Server *LCD_ServerOpen(const char *name) {
+    LCD_Server *server;
+    if (!name) name = LCD_SERVER_NAME;
+    server = calloc(1, sizeof(LCD_Server));
+    if (!server) return NULL;
+    server->shared = map_shared(name, 1);
+    if (!server->shared) {
+        free(server);
+        return NULL;
+    }
+    // a new server forgets any stale client
+    memset(server->shared, 0, sizeof(Shared));
+    __atomic_store_n(&server->shared->magic, SERVER_MAGIC, __ATOMIC_RELEASE);
+    strncpy(server->name, name, sizeof(server->name) - 1);
+
+    LCD_SetTarget(NULL);
+    server->screen = LCD_GetTarget();
+    return server;
+}
+
+void LCD_ServerClose(LCD_Server *server) {
+    if (!server) return;
+    __atomic_store_n(&server->shared->magic, 0, __ATOMIC_RELEASE);
+    munmap(server->shared, sizeof(Shared));
+    shm_unlink(server->name);
+    free(server);
+}
+
+// blocks until a client commits or the timeout (ms, -1 for none) expires
+int LCD_ServerWait(LCD_Server *server, int timeout_ms) {
+    unsigned int doorbell = __atomic_load_n(&server->shared->doorbell, __ATOMIC_ACQUIRE);
+    if (doorbell == server->doorbell) {
+        futex_wait(&server->shared->doorbell, doorbell, timeout_ms);
+        doorbell = __atomic_load_n(&server->shared->doorbell, __ATOMIC_ACQUIRE);
+    }
+    if (doorbell == server->doorbell) return 0;
+    server->doorbell = doorbell;
+    return 1;
+}
+
+// blanks the region shown for slot i, noting the changed columns
+static void blank(LCD_Server *server, int i, int *lo, int *hi) {
+    int b, x;
+    unsigned char mask, byte;
+    server->active[i] = 0;
+    for (b = server->y1[i] / 8; b <= server->y2[i] / 8; ++b) {
+        mask = bank_mask(b, server->y1[i], server->y2[i]);
+        for (x = server->x1[i]; x <= server->x2[i]; ++x) {
+            byte = server->screen[x + b * LCD_WIDTH] & ~mask;
+            if (byte == server->screen[x + b * LCD_WIDTH]) continue;
+            server->screen[x + b * LCD_WIDTH] = byte;
+            if (x < lo[b]) lo[b] = x;
+            if (x > hi[b]) hi[b] = x;
+        }
+    }
+}
+
+// Copies damaged client spans to the screen and sends the bytes that changed,
+// returns the number of spans transmitted. Regions of departed clients are
+// blanked first, then the slots overlapping them are composited again there
+// with their damage, so a new client never loses pixels to an old one.
+int LCD_ServerComposite(LCD_Server *server) {
+    int lo[LCD_BANKS], hi[LCD_BANKS];
+    int blanked[LCD_SERVER_MAX_CLIENTS][4];
+    int active[LCD_SERVER_MAX_CLIENTS];
+    int i, k, b, x, x1, x2, blanks = 0, spans = 0;
+    unsigned int damage;
+    unsigned char mask, byte;
+    Slot *slot;
+
+    for (b = 0; b < LCD_BANKS; ++b) {
+        lo[b] = LCD_WIDTH;
+        hi[b] = -1;
+    }
+
+    for (i = 0; i < LCD_SERVER_MAX_CLIENTS; ++i) {
+        slot = &server->shared->slots[i];
+        active[i] = __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE) == SLOT_ACTIVE;
+        // the client left, possibly replaced by another one since the last composite
+        if (server->active[i] && (!active[i] || server->generation[i] != slot->generation)) {
+            blanked[blanks][0] = server->x1[i];
+            blanked[blanks][1] = server->y1[i];
+            blanked[blanks][2] = server->x2[i];
+            blanked[blanks][3] = server->y2[i];
+            ++blanks;
+            blank(server, i, lo, hi);
+        }
+    }
+
+    for (i = 0; i < LCD_SERVER_MAX_CLIENTS; ++i) {
+        if (!active[i]) continue;
+        slot = &server->shared->slots[i];
+        server->active[i] = 1;
+        server->generation[i] = slot->generation;
+        server->x1[i] = slot->x1;
+        server->y1[i] = slot->y1;
+        server->x2[i] = slot->x2;
+        server->y2[i] = slot->y2;
+
+        for (b = slot->y1 / 8; b <= slot->y2 / 8; ++b) {
+            damage = __atomic_exchange_n(&slot->damage[b], NO_DAMAGE, __ATOMIC_ACQUIRE);
+            x1 = DAMAGE_LO(damage);
+            x2 = DAMAGE_HI(damage);
+            for (k = 0; k < blanks; ++k) {
+                if (blanked[k][1] / 8 > b || blanked[k][3] / 8 < b) continue;
+                if (blanked[k][0] < x1) x1 = blanked[k][0];
+                if (blanked[k][2] > x2) x2 = blanked[k][2];
+            }
+            x1 = x1 < slot->x1 ? slot->x1 : x1;
+            x2 = x2 > slot->x2 ? slot->x2 : x2;
+            mask = bank_mask(b, slot->y1, slot->y2);
+            for (x = x1; x <= x2; ++x) {
+                byte = (server->screen[x + b * LCD_WIDTH] & ~mask) |
+                       (slot->surface[x + b * LCD_WIDTH] & mask);
+                if (byte == server->screen[x + b * LCD_WIDTH]) continue;
+                server->screen[x + b * LCD_WIDTH] = byte;
+                if (x < lo[b]) lo[b] = x;
+                if (x > hi[b]) hi[b] = x;
+            }
+        }
+    }
+
+    for (b = 0; b < LCD_BANKS; ++b) {
+        if (lo[b] > hi[b]) continue;
+        LCD_DisplaySpan(b, lo[b], hi[b]);
+        ++spans;
+    }
+    return spans;
+}
+
+static int overlaps(const Slot *a, const Slot *b) {
+    return a->x1 <= b->x2 && b->x1 <= a->x2 && a->y1 <= b->y2 && b->y1 <= a->y2;
+}
+
+LCD_Client *LCD_ClientOpen(const char *name, int x1, int y1, int x2, int y2) {
+    LCD_Client *client;
+    Shared *shared;
+    Slot *slot = NULL;
+    unsigned int state;
+    int i, t;
+
+    if (x1 > x2) {
+        t = x1;
+        x1 = x2;
+        x2 = t;
+    }
+    if (y1 > y2) {
+        t = y1;
+        y1 = y2;
+        y2 = t;
+    }
+    x1 = x1 < 0 ? 0 : x1;
+    y1 = y1 < 0 ? 0 : y1;
+    x2 = x2 >= LCD_WIDTH ? LCD_WIDTH - 1 : x2;
+    y2 = y2 >= LCD_HEIGHT ? LCD_HEIGHT - 1 : y2;
+    if (x1 > x2 || y1 > y2) return NULL;
+
+    shared = map_shared(name ? name : LCD_SERVER_NAME, 0);
+    if (!shared) return NULL;
+    if (__atomic_load_n(&shared->magic, __ATOMIC_ACQUIRE) != SERVER_MAGIC) {
+        munmap(shared, sizeof(Shared));
+        return NULL;
+    }
+
+    for (i = 0; i < LCD_SERVER_MAX_CLIENTS && !slot; ++i) {
+        state = SLOT_FREE;
+        if (__atomic_compare_exchange_n(&shared->slots[i].state, &state, SLOT_CLAIMED, 0,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            slot = &shared->slots[i];
+    }
+    if (!slot) {
+        munmap(shared, sizeof(Shared));
+        return NULL;
+    }
+
+    ++slot->generation;
+    slot->x1 = x1;
+    slot->y1 = y1;
+    slot->x2 = x2;
+    slot->y2 = y2;
+    memset(slot->surface, 0, sizeof(LCD_Buffer));
+    for (i = 0; i < LCD_BANKS; ++i) {
+        slot->damage[i] = NO_DAMAGE;
+    }
+    __atomic_store_n(&slot->state, SLOT_PENDING, __ATOMIC_SEQ_CST);
+
+    // Regions are exclusive, the last one in backs off, and of two clients
+    // checking at once both may. The server only shows active slots, so it
+    // never sees a client that backs off.
+    for (i = 0; i < LCD_SERVER_MAX_CLIENTS; ++i) {
+        if (&shared->slots[i] == slot) continue;
+        state = __atomic_load_n(&shared->slots[i].state, __ATOMIC_SEQ_CST);
+        if ((state == SLOT_ACTIVE || state == SLOT_PENDING) && overlaps(&shared->slots[i], slot)) {
+            __atomic_store_n(&slot->state, SLOT_FREE, __ATOMIC_RELEASE);
+            munmap(shared, sizeof(Shared));
+            return NULL;
+        }
+    }
+
+    client = malloc(sizeof(LCD_Client));
+    if (!client) {
+        __atomic_store_n(&slot->state, SLOT_FREE, __ATOMIC_RELEASE);
+        munmap(shared, sizeof(Shared));
+        return NULL;
+    }
+    client->shared = shared;
+    client->slot = slot;
+    LCD_ClientDamage(client, x1, y1, x2, y2);
+    __atomic_store_n(&slot->state, SLOT_ACTIVE, __ATOMIC_RELEASE);
+    return client;
+}
+
+void LCD_ClientClose(LCD_Client *client) {
+    if (!client) return;
+    __atomic_store_n(&client->slot->state, SLOT_FREE, __ATOMIC_RELEASE);
+    LCD_ClientCommit(client);
+    munmap(client->shared, sizeof(Shared));
+    free(client);
+}
+
+// LCD_Buffer layout, in screen coordinates. Pass it to LCD_SetTarget to draw
+unsigned char *LCD_ClientSurface(LCD_Client *client) {
+    return client->slot->surface;
+}
+
+void LCD_ClientDamage(LCD_Client *client, int x1, int y1, int x2, int y2) {
+    Slot *slot = client->slot;
+    int b, t;
+    if (x1 > x2) {
+        t = x1;
+        x1 = x2;
+        x2 = t;
+    }
+    if (y1 > y2) {
+        t = y1;
+        y1 = y2;
+        y2 = t;
+    }
+    x1 = x1 < slot->x1 ? slot->x1 : x1;
+    y1 = y1 < slot->y1 ? slot->y1 : y1;
+    x2 = x2 > slot->x2 ? slot->x2 : x2;
+    y2 = y2 > slot->y2 ? slot->y2 : y2;
+    if (x1 > x2 || y1 > y2) return;
+    for (b = y1 / 8; b <= y2 / 8; ++b) {
+        merge_damage(&slot->damage[b], x1, x2);
+    }
+}
+
+// publishes the surface and wakes the server up
+void LCD_ClientCommit(LCD_Client *client) {
+    __atomic_add_fetch(&client->shared->doorbell, 1, __ATOMIC_RELEASE);
+    futex_wake(&client->shared->doorbell);
+}
@@ -0,0 +1,30 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "lcd.h"
+
+// Display server: a single process owns the LCD and composites screen regions
+// drawn by other processes. Each client gets a full LCD_Buffer surface in POSIX
+// shared memory, draws into it directly (see LCD_SetTarget), marks what changed
+// and rings the server. The server only copies and transmits damaged spans.
+
+#define LCD_SERVER_NAME "/lcd5110"
+#define LCD_SERVER_MAX_CLIENTS 8
+
+typedef struct LCD_Server LCD_Server;
+typedef struct LCD_Client LCD_Client;
+
+// server side
+LCD_Server *LCD_ServerOpen(const char *name);
+void LCD_ServerClose(LCD_Server *server);
+int LCD_ServerWait(LCD_Server *server, int timeout_ms);
+int LCD_ServerComposite(LCD_Server *server);
+
+// client side, a client owns the rectangle (x1, y1) - (x2, y2) of the screen
+LCD_Client *LCD_ClientOpen(const char *name, int x1, int y1, int x2, int y2);
+void LCD_ClientClose(LCD_Client *client);
+unsigned char *LCD_ClientSurface(LCD_Client *client);
+void LCD_ClientDamage(LCD_Client *client, int x1, int y1, int x2, int y2);
+void LCD_ClientCommit(LCD_Client *client);
+
+#endif
@@ -0,0 +1,342 @@
+#include <stddef.h>
+#include "shape.h"
+#include "transform.h"
+
+// A shape is a box (x1, y1, x2, y2) with elliptical corners of radii (rx, ry).
+// An ellipse is a box whose corners meet in the middle, a rounded rectangle
+// has rx == ry and a plain rectangle has no corners at all.
+// Being convex, such a shape covers exactly one span [top, bottom] per column.
+typedef struct {
+    int x1, y1, x2, y2;
+    int rx, ry;
+} Shape;
+
+// angular sector, as two direction vectors in doubled coordinates
+typedef struct {
+    int full;
+    int wide; // sweep over 180 degrees
+    long long sx, sy, ex, ey;
+    long long cx2, cy2;
+} Sector;
+
+typedef struct {
+    int top, bottom;
+} Span;
+
+// a column never needs more than 4 spans (ring minus a sector)
+#define MAX_SPANS 4
+
+static int normalize_angle(int angle) {
+    angle %= 360;
+    return angle < 0 ? angle + 360 : angle;
+}
+
+static long long isqrt(long long n) {
+    long long root = 0, bit = 1LL << 62;
+    if (n <= 0) return 0;
+    while (bit > n) bit >>= 2;
+    while (bit) {
+        if (n >= root + bit) {
+            n -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else root >>= 1;
+        bit >>= 2;
+    }
+    return root;
+}
+
+static long long floor_div(long long a, long long b) {
+    long long q = a / b;
+    if ((a % b) && ((a < 0) != (b < 0))) --q;
+    return q;
+}
+
+// half height of an ellipse of radii (rx, ry) at horizontal distance dx from its center.
+// A pixel is inside when x^2 / (rx + 1/2)^2 + y^2 / (ry + 1/2)^2 <= 1, which is
+// symmetric in both axes (unlike the octant walk of LCD_FillCircle).
+static int half_height(int dx, int rx, int ry) {
+    long long a = 2 * rx + 1, b = 2 * ry + 1;
+    if (dx <= 0) return ry;
+    if (dx > rx) return -1;
+    return (int)isqrt(b * b * (a * a - 4LL * dx * dx) / (4 * a * a));
+}
+
+// span covered by a shape in column x, returns 0 if the column is empty
+static int profile(const Shape *s, int x, int *top, int *bottom) {
+    int dx = 0, h;
+    if (s->x1 > s->x2 || s->y1 > s->y2 || x < s->x1 || x > s->x2) return 0;
+    if (x < s->x1 + s->rx) dx = s->x1 + s->rx - x;
+    else if (x > s->x2 - s->rx) dx = x - (s->x2 - s->rx);
+    h = half_height(dx, s->rx, s->ry);
+    *top = s->y1 + s->ry - h;
+    *bottom = s->y2 - s->ry + h;
+    return 1;
+}
+
+static void make_shape(Shape *s, int x1, int y1, int x2, int y2, int rx, int ry) {
+    int t;
+    if (x1 > x2) {
+        t = x1;
+        x1 = x2;
+        x2 = t;
+    }
+    if (y1 > y2) {
+        t = y1;
+        y1 = y2;
+        y2 = t;
+    }
+    // corners can't be larger than half the box
+    if (rx < 0) rx = 0;
+    if (ry < 0) ry = 0;
+    if (rx > (x2 - x1) / 2) rx = (x2 - x1) / 2;
+    if (ry > (y2 - y1) / 2) ry = (y2 - y1) / 2;
+    s->x1 = x1;
+    s->y1 = y1;
+    s->x2 = x2;
+    s->y2 = y2;
+    s->rx = rx;
+    s->ry = ry;
+}
+
+static void inset_shape(Shape *inner, const Shape *outer, int width) {
+    inner->x1 = outer->x1 + width;
+    inner->y1 = outer->y1 + width;
+    inner->x2 = outer->x2 - width;
+    inner->y2 = outer->y2 - width;
+    inner->rx = outer->rx > width ? outer->rx - width : 0;
+    inner->ry = outer->ry > width ? outer->ry - width : 0;
+}
+
+// removes [top, bottom] from a span list, returns the new span count
+static int subtract(Span *spans, int n, int top, int bottom) {
+    Span out[MAX_SPANS];
+    int i, count = 0;
+    if (top > bottom) return n;
+    for (i = 0; i < n; ++i) {
+        if (spans[i].bottom < top || spans[i].top > bottom) {
+            out[count++] = spans[i];
+            continue;
+        }
+        if (spans[i].top < top && count < MAX_SPANS) {
+            out[count].top = spans[i].top;
+            out[count++].bottom = top - 1;
+        }
+        if (spans[i].bottom > bottom && count < MAX_SPANS) {
+            out[count].top = bottom + 1;
+            out[count++].bottom = spans[i].bottom;
+        }
+    }
+    for (i = 0; i < count; ++i) spans[i] = out[i];
+    return count;
+}
+
+// keeps only [top, bottom] of a span list
+static int intersect(Span *spans, int n, int top, int bottom) {
+    int i, count = 0;
+    for (i = 0; i < n; ++i) {
+        if (spans[i].top < top) spans[i].top = top;
+        if (spans[i].bottom > bottom) spans[i].bottom = bottom;
+        if (spans[i].top <= spans[i].bottom) spans[count++] = spans[i];
+    }
+    return count;
+}
+
+// outline: pixels of the shape with at least one 4-neighbour outside of it
+static int outline_spans(const Shape *s, int x, Span *spans) {
+    int top, bottom, t, b, it, ib;
+    if (!profile(s, x, &top, &bottom)) return 0;
+    spans[0].top = top;
+    spans[0].bottom = bottom;
+    it = top + 1;
+    ib = bottom - 1;
+    if (!profile(s, x - 1, &t, &b)) return 1;
+    if (t > it) it = t;
+    if (b < ib) ib = b;
+    if (!profile(s, x + 1, &t, &b)) return 1;
+    if (t > it) it = t;
+    if (b < ib) ib = b;
+    return subtract(spans, 1, it, ib);
+}
+
+static int fill_spans(const Shape *s, int x, Span *spans) {
+    if (!profile(s, x, &spans[0].top, &spans[0].bottom)) return 0;
+    return 1;
+}
+
+static int stroke_spans(const Shape *s, const Shape *inner, int width, int x, Span *spans) {
+    int top, bottom;
+    if (width <= 1) return outline_spans(s, x, spans);
+    if (!fill_spans(s, x, spans)) return 0;
+    if (!profile(inner, x, &top, &bottom)) return 1;
+    return subtract(spans, 1, top, bottom);
+}
+
+static void make_sector(Sector *sector, const Shape *s, int start, int end) {
+    int sweep = normalize_angle(end - start);
+    int rx = s->rx ? s->rx : 1, ry = s->ry ? s->ry : 1;
+    sector->full = (sweep == 0 && end != start);
+    sector->wide = sweep > 180;
+    // parametric angles, so that the arc ends on (x + rx cos, y - ry sin)
+    sector->sx = (long long)rx * LCD_Cos(start);
+    sector->sy = (long long)ry * LCD_Sin(start);
+    sector->ex = (long long)rx * LCD_Cos(end);
+    sector->ey = (long long)ry * LCD_Sin(end);
+    sector->cx2 = s->x1 + s->x2;
+    sector->cy2 = s->y1 + s->y2;
+}
+
+// solves a * y <= c (or a * y < c when strict) as a range of y
+static void half_line(long long a, long long c, int strict, long long *lo, long long *hi) {
+    if (strict) --c;
+    if (a > 0) {
+        *lo = -(1LL << 40);
+        *hi = floor_div(c, a);
+    }
+    else if (a < 0) {
+        *lo = -floor_div(c, -a);
+        *hi = 1LL << 40;
+    }
+    else if (c >= 0) {
+        *lo = -(1LL << 40);
+        *hi = 1LL << 40;
+    }
+    else {
+        *lo = 1;
+        *hi = 0;
+    }
+}
+
+// rows of column x lying between direction vectors (sx, sy) and (ex, ey)
+// counter-clockwise (sweep <= 180). Vertical screen axis points down, so the
+// math vector of pixel (x, y) is (2x - cx2, cy2 - 2y) in doubled coordinates.
+static void sector_range(long long sx, long long sy, long long ex, long long ey,
+                         long long cx2, long long cy2, int x, int strict,
+                         long long *lo, long long *hi) {
+    long long px = 2LL * x - cx2, l, h;
+    // cross(S, P) >= 0: sx * (cy2 - 2y) - sy * px >= 0
+    half_line(2 * sx, sx * cy2 - sy * px, strict, lo, hi);
+    // cross(P, E) >= 0: px * ey - (cy2 - 2y) * ex >= 0
+    half_line(-2 * ex, px * ey - ex * cy2, strict, &l, &h);
+    if (l > *lo) *lo = l;
+    if (h < *hi) *hi = h;
+}
+
+static int clip_sector(const Sector *sector, int x, Span *spans, int n) {
+    long long lo, hi;
+    if (sector->full || !n) return n;
+    if (!sector->wide) {
+        sector_range(sector->sx, sector->sy, sector->ex, sector->ey,
+                     sector->cx2, sector->cy2, x, 0, &lo, &hi);
+        if (lo > hi) return 0;
+        return intersect(spans, n, lo < -(1 << 30) ? -(1 << 30) : (int)lo,
+                         hi > (1 << 30) ? (1 << 30) : (int)hi);
+    }
+    // wide arcs: remove the open complementary sector, keeping both edges
+    sector_range(sector->ex, sector->ey, sector->sx, sector->sy,
+                 sector->cx2, sector->cy2, x, 1, &lo, &hi);
+    if (lo > hi) return n;
+    return subtract(spans, n, lo < -(1 << 30) ? -(1 << 30) : (int)lo,
+                    hi > (1 << 30) ? (1 << 30) : (int)hi);
+}
+
+static void emit_spans(int x, const Span *spans, int n, LCD_COLOR color) {
+    int i;
+    for (i = 0; i < n; ++i)
+        LCD_VerticalLine(x, spans[i].top, spans[i].bottom, color);
+}
+
+typedef enum {
+    SHAPE_OUTLINE,
+    SHAPE_FILL,
+    SHAPE_STROKE
+} SHAPE_STYLE;
+
+static void render(const Shape *s, SHAPE_STYLE style, int width,
+                   const Sector *sector, LCD_COLOR color) {
+    Shape inner;
+    Span spans[MAX_SPANS];
+    int x, x1, x2, n, cx1, cy1, cx2, cy2;
+
+    // only the columns and rows of the clip rectangle, in drawing coordinates
+    LCD_GetClip(&cx1, &cy1, &cx2, &cy2);
+    inset_shape(&inner, s, width);
+    x1 = s->x1 < cx1 ? cx1 : s->x1;
+    x2 = s->x2 > cx2 ? cx2 : s->x2;
+    for (x = x1; x <= x2; ++x) {
+        switch (style) {
+        case SHAPE_OUTLINE:
+            n = outline_spans(s, x, spans);
+            break;
+        case SHAPE_FILL:
+            n = fill_spans(s, x, spans);
+            break;
+        default:
+            n = stroke_spans(s, &inner, width, x, spans);
+            break;
+        }
+        if (sector) n = clip_sector(sector, x, spans, n);
+        n = intersect(spans, n, cy1, cy2);
+        emit_spans(x, spans, n, color);
+    }
+}
+
+static void render_ellipse(int x, int y, int rx, int ry, SHAPE_STYLE style, int width,
+                           int arc, int start, int end, LCD_COLOR color) {
+    Shape s;
+    Sector sector;
+    if (rx < 0 || ry < 0) return;
+    make_shape(&s, x - rx, y - ry, x + rx, y + ry, rx, ry);
+    if (arc) make_sector(&sector, &s, start, end);
+    render(&s, style, width, arc ? &sector : NULL, color);
+}
+
+void LCD_DrawEllipse(int x, int y, int rx, int ry, LCD_COLOR color) {
+    render_ellipse(x, y, rx, ry, SHAPE_OUTLINE, 1, 0, 0, 0, color);
+}
+
+void LCD_FillEllipse(int x, int y, int rx, int ry, LCD_COLOR color) {
+    render_ellipse(x, y, rx, ry, SHAPE_FILL, 1, 0, 0, 0, color);
+}
+
+void LCD_StrokeEllipse(int x, int y, int rx, int ry, int width, LCD_COLOR color) {
+    render_ellipse(x, y, rx, ry, SHAPE_STROKE, width, 0, 0, 0, color);
+}
+
+void LCD_StrokeCircle(int x, int y, int radius, int width, LCD_COLOR color) {
+    render_ellipse(x, y, radius, radius, SHAPE_STROKE, width, 0, 0, 0, color);
+}
+
+void LCD_DrawArc(int x, int y, int rx, int ry, int start, int end, LCD_COLOR color) {
+    render_ellipse(x, y, rx, ry, SHAPE_OUTLINE, 1, 1, start, end, color);
+}
+
+void LCD_StrokeArc(int x, int y, int rx, int ry, int start, int end, int width, LCD_COLOR color) {
+    render_ellipse(x, y, rx, ry, SHAPE_STROKE, width, 1, start, end, color);
+}
+
+void LCD_FillPie(int x, int y, int rx, int ry, int start, int end, LCD_COLOR color) {
+    render_ellipse(x, y, rx, ry, SHAPE_FILL, 1, 1, start, end, color);
+}
+
+void LCD_DrawRoundRect(int x1, int y1, int x2, int y2, int radius, LCD_COLOR color) {
+    Shape s;
+    make_shape(&s, x1, y1, x2, y2, radius, radius);
+    render(&s, SHAPE_OUTLINE, 1, NULL, color);
+}
+
+void LCD_FillRoundRect(int x1, int y1, int x2, int y2, int radius, LCD_COLOR color) {
+    Shape s;
+    make_shape(&s, x1, y1, x2, y2, radius, radius);
+    render(&s, SHAPE_FILL, 1, NULL, color);
+}
+
+void LCD_StrokeRoundRect(int x1, int y1, int x2, int y2, int radius, int width, LCD_COLOR color) {
+    Shape s;
+    make_shape(&s, x1, y1, x2, y2, radius, radius);
+    render(&s, SHAPE_STROKE, width, NULL, color);
+}
+
+void LCD_StrokeRect(int x1, int y1, int x2, int y2, int width, LCD_COLOR color) {
+    LCD_StrokeRoundRect(x1, y1, x2, y2, 0, width, color);
+}
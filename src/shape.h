@@ -0,0 +1,28 @@
+#ifndef SHAPE_H
+#define SHAPE_H
+
+#include "lcd.h"
+
+// Ellipse, arc, rounded rectangle and thick stroke rasterizers.
+// Every shape is reduced to a list of disjoint vertical spans per column,
+// which are then drawn with LCD_VerticalLine. No pixel is ever touched twice,
+// so XOR mode is safe for every primitive below.
+//
+// Angles are in degrees, 0 pointing right and increasing counter-clockwise
+// (90 points up). An arc is drawn from start to end, counter-clockwise.
+
+void LCD_DrawEllipse(int x, int y, int rx, int ry, LCD_COLOR color);
+void LCD_FillEllipse(int x, int y, int rx, int ry, LCD_COLOR color);
+void LCD_StrokeEllipse(int x, int y, int rx, int ry, int width, LCD_COLOR color);
+void LCD_StrokeCircle(int x, int y, int radius, int width, LCD_COLOR color);
+
+void LCD_DrawArc(int x, int y, int rx, int ry, int start, int end, LCD_COLOR color);
+void LCD_StrokeArc(int x, int y, int rx, int ry, int start, int end, int width, LCD_COLOR color);
+void LCD_FillPie(int x, int y, int rx, int ry, int start, int end, LCD_COLOR color);
+
+void LCD_DrawRoundRect(int x1, int y1, int x2, int y2, int radius, LCD_COLOR color);
+void LCD_FillRoundRect(int x1, int y1, int x2, int y2, int radius, LCD_COLOR color);
+void LCD_StrokeRoundRect(int x1, int y1, int x2, int y2, int radius, int width, LCD_COLOR color);
+void LCD_StrokeRect(int x1, int y1, int x2, int y2, int width, LCD_COLOR color);
+
+#endif
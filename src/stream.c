@@ -0,0 +1,263 @@
+#include <stddef.h>
+#include "stream.h"
+#ifndef LCD_NO_TEXT
+#include "font.h"
+#endif
+
+typedef enum {
+    OP_CLEAR,
+    OP_INVERT,
+    OP_PIXEL,
+    OP_LINE,
+    OP_HLINE,
+    OP_VLINE,
+    OP_FILL_RECT,
+    OP_DRAW_RECT,
+    OP_DRAW_CIRCLE,
+    OP_FILL_CIRCLE,
+    OP_BLIT,
+    OP_TEXT,
+    OP_PUSH_CLIP,
+    OP_PUSH_VIEWPORT,
+    OP_POP_CLIP
+} OP;
+
+// rows of operations replayed on every row
+#define ALL_ROWS_TOP (-32768)
+#define ALL_ROWS_BOTTOM 32767
+
+void LCD_StreamInit(LCD_Stream *stream, LCD_StreamOp *ops, int capacity) {
+    stream->ops = ops;
+    stream->capacity = capacity;
+    LCD_StreamReset(stream);
+}
+
+void LCD_StreamReset(LCD_Stream *stream) {
+    stream->count = 0;
+    stream->depth = 0;
+    stream->viewports = 0;
+}
+
+static int clamp_short(int value) {
+    return value < -32768 ? -32768 : value > 32767 ? 32767 : value;
+}
+
+// Inside viewports the rows reached on the canvas depend on the origin, they
+// are only known when replaying.
+static int record(LCD_Stream *stream, OP op, int color, int a, int b, int c, int d,
+                  int top, int bottom, const void *data) {
+    LCD_StreamOp *o;
+    if (stream->count == stream->capacity) return 1;
+    o = &stream->ops[stream->count++];
+    o->op = (unsigned char)op;
+    o->color = (unsigned char)color;
+    o->a = (short)a;
+    o->b = (short)b;
+    o->c = (short)c;
+    o->d = (short)d;
+    if (top > bottom) {
+        int t = top;
+        top = bottom;
+        bottom = t;
+    }
+    o->top = (short)clamp_short(stream->viewports ? ALL_ROWS_TOP : top);
+    o->bottom = (short)clamp_short(stream->viewports ? ALL_ROWS_BOTTOM : bottom);
+    o->data = data;
+    return 0;
+}
+
+int LCD_StreamClear(LCD_Stream *stream) {
+    return record(stream, OP_CLEAR, 0, 0, 0, 0, 0, ALL_ROWS_TOP, ALL_ROWS_BOTTOM, NULL);
+}
+
+int LCD_StreamInvert(LCD_Stream *stream) {
+    return record(stream, OP_INVERT, 0, 0, 0, 0, 0, ALL_ROWS_TOP, ALL_ROWS_BOTTOM, NULL);
+}
+
+int LCD_StreamPixel(LCD_Stream *stream, int x, int y, LCD_COLOR color) {
+    return record(stream, OP_PIXEL, color, x, y, 0, 0, y, y, NULL);
+}
+
+int LCD_StreamLine(LCD_Stream *stream, int x1, int y1, int x2, int y2, LCD_COLOR color) {
+    return record(stream, OP_LINE, color, x1, y1, x2, y2, y1, y2, NULL);
+}
+
+int LCD_StreamHorizontalLine(LCD_Stream *stream, int y, int x1, int x2, LCD_COLOR color) {
+    return record(stream, OP_HLINE, color, y, x1, x2, 0, y, y, NULL);
+}
+
+int LCD_StreamVerticalLine(LCD_Stream *stream, int x, int y1, int y2, LCD_COLOR color) {
+    return record(stream, OP_VLINE, color, x, y1, y2, 0, y1, y2, NULL);
+}
+
+int LCD_StreamFillRect(LCD_Stream *stream, int x1, int y1, int x2, int y2, LCD_COLOR color) {
+    return record(stream, OP_FILL_RECT, color, x1, y1, x2, y2, y1, y2, NULL);
+}
+
+int LCD_StreamDrawRect(LCD_Stream *stream, int x1, int y1, int x2, int y2, LCD_COLOR color) {
+    return record(stream, OP_DRAW_RECT, color, x1, y1, x2, y2, y1, y2, NULL);
+}
+
+#ifndef LCD_NO_CIRCLES
+
+int LCD_StreamDrawCircle(LCD_Stream *stream, int x, int y, int radius, LCD_COLOR color) {
+    return record(stream, OP_DRAW_CIRCLE, color, x, y, radius, 0, y - radius, y + radius, NULL);
+}
+
+int LCD_StreamFillCircle(LCD_Stream *stream, int x, int y, int radius, LCD_COLOR color) {
+    return record(stream, OP_FILL_CIRCLE, color, x, y, radius, 0, y - radius, y + radius, NULL);
+}
+
+#endif
+
+int LCD_StreamBlit(LCD_Stream *stream, const unsigned char *buffer, int x1, int y1, int w, int h, LCD_COLOR mode) {
+    return record(stream, OP_BLIT, mode, x1, y1, w, h, y1, y1 + h - 1, buffer);
+}
+
+#ifndef LCD_NO_TEXT
+
+int LCD_StreamText(LCD_Stream *stream, int x, int y, const char *text, LCD_COLOR mode) {
+    return record(stream, OP_TEXT, mode, x, y, 0, 0, y, y + LCD_CHAR_HEIGHT - 1, text);
+}
+
+#endif
+
+// the recorded clip stack tells which operations are inside viewports
+int LCD_StreamPushClip(LCD_Stream *stream, int x1, int y1, int x2, int y2) {
+    if (stream->depth == LCD_CLIP_DEPTH) return 1;
+    if (record(stream, OP_PUSH_CLIP, 0, x1, y1, x2, y2, ALL_ROWS_TOP, ALL_ROWS_BOTTOM, NULL)) return 1;
+    stream->viewports &= ~(1u << stream->depth++);
+    return 0;
+}
+
+int LCD_StreamPushViewport(LCD_Stream *stream, int x1, int y1, int x2, int y2) {
+    if (stream->depth == LCD_CLIP_DEPTH) return 1;
+    if (record(stream, OP_PUSH_VIEWPORT, 0, x1, y1, x2, y2, ALL_ROWS_TOP, ALL_ROWS_BOTTOM, NULL)) return 1;
+    stream->viewports |= 1u << stream->depth++;
+    return 0;
+}
+
+int LCD_StreamPopClip(LCD_Stream *stream) {
+    if (!stream->depth) return 0;
+    if (record(stream, OP_POP_CLIP, 0, 0, 0, 0, 0, ALL_ROWS_TOP, ALL_ROWS_BOTTOM, NULL)) return 1;
+    stream->viewports &= ~(1u << --stream->depth);
+    return 0;
+}
+
+// clip stack state while replaying on a row
+typedef struct {
+    int dx, dy; // screen position on the canvas
+    int depth; // pushes that succeeded
+    unsigned int viewports; // which of them are viewports
+    int dropped; // pushes lost to a full stack, their pops are skipped
+} Replay;
+
+// Canvas coordinates are moved to the screen outside of viewports, inside
+// they are relative to the viewport.
+static void replay(const LCD_StreamOp *o, Replay *r) {
+    LCD_COLOR color = (LCD_COLOR)o->color;
+    int dx = r->viewports ? 0 : r->dx, dy = r->viewports ? 0 : r->dy;
+    switch (o->op) {
+    case OP_CLEAR:
+        LCD_Clear();
+        break;
+    case OP_INVERT:
+        LCD_Invert();
+        break;
+    case OP_PIXEL:
+        LCD_Pixel(o->a - dx, o->b - dy, color);
+        break;
+    case OP_LINE:
+        LCD_DrawLine(o->a - dx, o->b - dy, o->c - dx, o->d - dy, color);
+        break;
+    case OP_HLINE:
+        LCD_HorizontalLine(o->a - dy, o->b - dx, o->c - dx, color);
+        break;
+    case OP_VLINE:
+        LCD_VerticalLine(o->a - dx, o->b - dy, o->c - dy, color);
+        break;
+    case OP_FILL_RECT:
+        LCD_FillRect(o->a - dx, o->b - dy, o->c - dx, o->d - dy, color);
+        break;
+    case OP_DRAW_RECT:
+        LCD_DrawRect(o->a - dx, o->b - dy, o->c - dx, o->d - dy, color);
+        break;
+#ifndef LCD_NO_CIRCLES
+    case OP_DRAW_CIRCLE:
+        LCD_DrawCircle(o->a - dx, o->b - dy, o->c, color);
+        break;
+    case OP_FILL_CIRCLE:
+        LCD_FillCircle(o->a - dx, o->b - dy, o->c, color);
+        break;
+#endif
+    case OP_BLIT:
+        LCD_Blit((const unsigned char *)o->data, o->a - dx, o->b - dy, o->c, o->d, color);
+        break;
+#ifndef LCD_NO_TEXT
+    case OP_TEXT:
+        LCD_TextLocate(o->a - dx, o->b - dy);
+        LCD_TextMode(color);
+        LCD_Text((const char *)o->data);
+        break;
+#endif
+    case OP_PUSH_CLIP:
+        if (r->dropped || LCD_PushClip(o->a - dx, o->b - dy, o->c - dx, o->d - dy)) ++r->dropped;
+        else r->viewports &= ~(1u << r->depth++);
+        break;
+    case OP_PUSH_VIEWPORT:
+        if (r->dropped || LCD_PushViewport(o->a - dx, o->b - dy, o->c - dx, o->d - dy)) ++r->dropped;
+        else r->viewports |= 1u << r->depth++;
+        break;
+    case OP_POP_CLIP:
+        if (r->dropped) --r->dropped;
+        else if (r->depth) {
+            LCD_PopClip();
+            r->viewports &= ~(1u << --r->depth);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void LCD_StreamRenderRow(const LCD_Stream *stream, int x, int y, int bank, unsigned char *row) {
+    unsigned char *target = LCD_GetTarget();
+    const LCD_StreamOp *o;
+    Replay r;
+    int i, ox, oy, top, bottom;
+
+    for (i = 0; i < LCD_WIDTH; ++i) {
+        row[i] = 0;
+    }
+
+    // canvas rows landing on this bank row
+    LCD_GetOrigin(&ox, &oy);
+    top = bank * 8 - oy + y;
+    bottom = top + 7;
+
+    r.dx = x;
+    r.dy = y;
+    r.depth = 0;
+    r.viewports = 0;
+    r.dropped = 0;
+
+    LCD_SetTargetRows(row, bank, 1);
+    for (i = 0; i < stream->count; ++i) {
+        o = &stream->ops[i];
+        if (o->bottom < top || o->top > bottom) continue;
+        replay(o, &r);
+    }
+    while (r.depth--) {
+        LCD_PopClip();
+    }
+    LCD_SetTarget(target);
+}
+
+void LCD_StreamDisplay(const LCD_Stream *stream, int x, int y) {
+    unsigned char rows[2][LCD_WIDTH];
+    int bank;
+    for (bank = 0; bank < LCD_HEIGHT / 8; ++bank) {
+        LCD_StreamRenderRow(stream, x, y, bank, rows[bank & 1]);
+        LCD_DisplayRow(bank, rows[bank & 1]);
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include "lcd.h"
+
+// Streamed frames, rendered one bank row at a time from a recorded list of
+// primitives instead of a screen buffer. Each row is rasterized by replaying
+// the primitives that reach it, clipped to it, then sent with LCD_DisplayRow
+// while the next row is rasterized in a second row buffer, so a bus that sends
+// in the background (DMA behind the bus hook) overlaps with drawing. RAM use
+// is the list and two rows, and the result is bit-identical to drawing the
+// same primitives in the screen buffer.
+//
+// The list may describe a canvas larger than the screen: LCD_StreamDisplay
+// takes the position of the screen on the canvas.
+//
+//     LCD_StreamInit(&stream, ops, 64);
+//     LCD_StreamFillRect(&stream, 0, 0, 200, 10, BLACK);
+//     LCD_StreamText(&stream, 2, 2, "score", XOR);
+//     LCD_StreamDisplay(&stream, scroll, 0);
+
+typedef struct {
+    unsigned char op;
+    unsigned char color; // color or blit mode
+    short a, b, c, d; // arguments of the primitive
+    short top, bottom; // rows reached on the canvas
+    const void *data; // bitmap or text, kept by the caller until displayed
+} LCD_StreamOp;
+
+typedef struct {
+    LCD_StreamOp *ops;
+    int capacity;
+    int count;
+    int depth; // clip rectangles open while recording, up to LCD_CLIP_DEPTH
+    unsigned int viewports; // which of them are viewports
+} LCD_Stream;
+
+void LCD_StreamInit(LCD_Stream *stream, LCD_StreamOp *ops, int capacity);
+void LCD_StreamReset(LCD_Stream *stream);
+
+// same arguments as the lcd.h primitives, return 1 when the list is full
+int LCD_StreamClear(LCD_Stream *stream);
+int LCD_StreamInvert(LCD_Stream *stream);
+int LCD_StreamPixel(LCD_Stream *stream, int x, int y, LCD_COLOR color);
+int LCD_StreamLine(LCD_Stream *stream, int x1, int y1, int x2, int y2, LCD_COLOR color);
+int LCD_StreamHorizontalLine(LCD_Stream *stream, int y, int x1, int x2, LCD_COLOR color);
+int LCD_StreamVerticalLine(LCD_Stream *stream, int x, int y1, int y2, LCD_COLOR color);
+int LCD_StreamFillRect(LCD_Stream *stream, int x1, int y1, int x2, int y2, LCD_COLOR color);
+int LCD_StreamDrawRect(LCD_Stream *stream, int x1, int y1, int x2, int y2, LCD_COLOR color);
+#ifndef LCD_NO_CIRCLES
+int LCD_StreamDrawCircle(LCD_Stream *stream, int x, int y, int radius, LCD_COLOR color);
+int LCD_StreamFillCircle(LCD_Stream *stream, int x, int y, int radius, LCD_COLOR color);
+#endif
+int LCD_StreamBlit(LCD_Stream *stream, const unsigned char *buffer, int x1, int y1, int w, int h, LCD_COLOR mode);
+#ifndef LCD_NO_TEXT
+// one line of text, drawn like LCD_TextLocate(x, y), LCD_TextMode(mode), LCD_Text(text)
+int LCD_StreamText(LCD_Stream *stream, int x, int y, const char *text, LCD_COLOR mode);
+#endif
+int LCD_StreamPushClip(LCD_Stream *stream, int x1, int y1, int x2, int y2);
+int LCD_StreamPushViewport(LCD_Stream *stream, int x1, int y1, int x2, int y2);
+int LCD_StreamPopClip(LCD_Stream *stream);
+
+// Renders the rows of the canvas seen from (x, y) and sends them. The clip
+// rectangle and origin of the calling thread apply as for direct drawing.
+void LCD_StreamDisplay(const LCD_Stream *stream, int x, int y);
+
+// renders bank row bank of the screen into row, LCD_WIDTH bytes
+void LCD_StreamRenderRow(const LCD_Stream *stream, int x, int y, int bank, unsigned char *row);
+
+#endif
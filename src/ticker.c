@@ -0,0 +1,96 @@
+#include <string.h>
+#include "ticker.h"
+#include "font.h"
+
+#define GLYPH_MASK ((1 << LCD_CHAR_HEIGHT) - 1)
+
+void LCD_TickerInit(LCD_Ticker *ticker, int x, int y, int w, int speed, int gap) {
+    memset(ticker, 0, sizeof(*ticker));
+    ticker->x = x;
+    ticker->y = y;
+    ticker->w = w;
+    ticker->speed = speed;
+    ticker->gap = gap < 0 ? 0 : gap > LCD_WIDTH ? LCD_WIDTH : gap;
+    ticker->length = ticker->gap;
+}
+
+// NULL clears the text, like ""
+void LCD_TickerSetText(LCD_Ticker *ticker, const char *text) {
+    int i, c, column = 0;
+    unsigned char glyph;
+
+    if (!text) text = "";
+    if (!strncmp(ticker->text, text, LCD_TICKER_TEXT)) return;
+    strncpy(ticker->text, text, LCD_TICKER_TEXT);
+    ticker->text[LCD_TICKER_TEXT] = '\0';
+
+    for (i = 0; ticker->text[i]; ++i) {
+        glyph = (unsigned char)ticker->text[i];
+        glyph = glyph < 0x20 || glyph > 0x7F ? 0 : glyph - 0x20;
+        for (c = 0; c < LCD_CHAR_WIDTH; ++c)
+            ticker->strip[column++] = LCD_font[glyph][c] & GLYPH_MASK;
+        ticker->strip[column++] = 0;
+    }
+    memset(ticker->strip + column, 0, ticker->gap);
+    ticker->length = column + ticker->gap;
+    if (ticker->length)
+        ticker->position %= ticker->length * 256;
+}
+
+void LCD_TickerSetSpeed(LCD_Ticker *ticker, int speed) {
+    ticker->speed = speed;
+}
+
+void LCD_TickerStep(LCD_Ticker *ticker) {
+    int period = ticker->length * 256;
+    if (!period) return;
+    ticker->position = (ticker->position + ticker->speed) % period;
+    if (ticker->position < 0) ticker->position += period;
+}
+
+static void blend(unsigned char *dst, unsigned char src, unsigned char mask, LCD_COLOR mode) {
+    switch (mode & MODE) {
+    case WHITE: *dst = (*dst & ~mask) | (~src & mask); break;
+    case BLACK: *dst = (*dst & ~mask) | src; break;
+    case OR: *dst |= src; break;
+    case XOR: *dst ^= src; break;
+    case AND: *dst &= src | ~mask; break;
+    default: break;
+    }
+    if (mode & NOT) *dst ^= mask;
+}
+
+void LCD_TickerDraw(const LCD_Ticker *ticker, LCD_COLOR mode) {
+    unsigned char *buffer = LCD_GetTarget(), *top = NULL, *bottom = NULL;
+    int shift, bank, x1, x2, x, y, column, row, cx1, cy1, cx2, cy2, ox, oy;
+    unsigned int src, mask, rows = 0;
+
+    if (!ticker->length) return;
+    LCD_GetClip(&cx1, &cy1, &cx2, &cy2);
+    LCD_GetOrigin(&ox, &oy);
+    x1 = ticker->x < cx1 ? cx1 : ticker->x;
+    x2 = ticker->x + ticker->w > cx2 + 1 ? cx2 + 1 : ticker->x + ticker->w;
+    if (x1 >= x2) return;
+
+    // glyph rows inside the clip rectangle
+    for (row = 0; row < LCD_CHAR_HEIGHT; ++row)
+        if (ticker->y + row >= cy1 && ticker->y + row <= cy2) rows |= 1 << row;
+    if (!(rows &= GLYPH_MASK)) return;
+
+    // a glyph row straddles at most two banks
+    y = ticker->y + oy;
+    shift = y & 7;
+    bank = (y - shift) / 8;
+    mask = rows << shift;
+    if (bank >= 0 && (mask & 0xFF)) top = buffer + bank * LCD_WIDTH;
+    if (bank + 1 < LCD_HEIGHT / 8 && mask > 0xFF) bottom = buffer + (bank + 1) * LCD_WIDTH;
+
+    column = (ticker->position >> 8) + (x1 - ticker->x);
+    column %= ticker->length;
+    for (x = x1 + ox; x < x2 + ox; ++x) {
+        src = (unsigned int)(ticker->strip[column] & rows) << shift;
+        if (top) blend(top + x, (unsigned char)src, (unsigned char)mask, mode);
+        if (bottom) blend(bottom + x, (unsigned char)(src >> 8), (unsigned char)(mask >> 8), mode);
+        if (++column == ticker->length) column = 0;
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef TICKER_H
+#define TICKER_H
+
+#include "lcd.h"
+
+// Scrolling text tickers.
+// The text is rendered once into a strip of bank bytes, one byte per column
+// with the glyphs in the top 5 bits. Drawing copies a window of the strip to
+// the screen in a single pass, wrapping around its end, so frames cost the
+// same whatever the text. Setting the same text again renders nothing.
+
+#define LCD_TICKER_TEXT 64
+#define LCD_TICKER_ADVANCE 4 // LCD_CHAR_WIDTH + 1
+#define LCD_TICKER_STRIP (LCD_TICKER_TEXT * LCD_TICKER_ADVANCE + LCD_WIDTH)
+
+typedef struct {
+    int x, y, w; // window on screen, one glyph high
+    int speed; // 1/256 of a column per step, negative scrolls right
+    int position; // 1/256 of a column, in [0, length * 256)
+    int gap; // blank columns between repetitions
+    int length; // strip columns, gap included
+
+    char text[LCD_TICKER_TEXT + 1];
+    unsigned char strip[LCD_TICKER_STRIP];
+} LCD_Ticker;
+
+void LCD_TickerInit(LCD_Ticker *ticker, int x, int y, int w, int speed, int gap);
+void LCD_TickerSetText(LCD_Ticker *ticker, const char *text);
+void LCD_TickerSetSpeed(LCD_Ticker *ticker, int speed);
+void LCD_TickerStep(LCD_Ticker *ticker);
+// XOR, OR and AND blend as in LCD_Blit, BLACK and WHITE paint the window opaque
+void LCD_TickerDraw(const LCD_Ticker *ticker, LCD_COLOR mode);
+
+#endif
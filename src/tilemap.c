@@ -0,0 +1,162 @@
+#include <string.h>
+#include "tilemap.h"
+
+#define LCD_BANKS (LCD_HEIGHT / 8)
+
+static int wrap(int n, int m) {
+    n %= m;
+    return n < 0 ? n + m : n;
+}
+
+static const unsigned char *tile(const LCD_Tilemap *tilemap, int tx, int ty) {
+    int index = tilemap->map[wrap(ty, tilemap->height) * tilemap->width + wrap(tx, tilemap->width)];
+    return tilemap->tileset + index * LCD_TILE_SIZE;
+}
+
+// renders frame columns x1..x2 for the current camera
+static void render_columns(LCD_Tilemap *tilemap, int x1, int x2) {
+    int shift = wrap(tilemap->y, LCD_TILE_SIZE);
+    int ty = (tilemap->y - shift) / LCD_TILE_SIZE;
+    int b, x, i, px, column, n;
+    const unsigned char *up, *down;
+    unsigned char *row;
+
+    for (b = 0; b < LCD_BANKS; ++b) {
+        row = tilemap->frame + b * LCD_WIDTH;
+        for (x = x1; x <= x2; x += n) {
+            px = tilemap->x + x;
+            column = wrap(px, LCD_TILE_SIZE);
+            n = LCD_TILE_SIZE - column;
+            if (n > x2 - x + 1) n = x2 - x + 1;
+            up = tile(tilemap, (px - column) / LCD_TILE_SIZE, ty + b) + column;
+            if (!shift) {
+                memcpy(row + x, up, n);
+                continue;
+            }
+            // the bank row straddles two tile rows
+            down = tile(tilemap, (px - column) / LCD_TILE_SIZE, ty + b + 1) + column;
+            for (i = 0; i < n; ++i) {
+                row[x + i] = (up[i] >> shift) | (down[i] << (LCD_TILE_SIZE - shift));
+            }
+        }
+    }
+}
+
+// 8 frame rows starting at row y of column x, blank below and above the frame
+static unsigned char frame_byte(const unsigned char *frame, int x, int y) {
+    int shift = y & 7, b = (y - shift) / 8;
+    unsigned int byte = 0;
+    if (b >= 0 && b < LCD_BANKS) byte = frame[b * LCD_WIDTH + x] >> shift;
+    if (shift && b + 1 >= 0 && b + 1 < LCD_BANKS) byte |= frame[(b + 1) * LCD_WIDTH + x] << (8 - shift);
+    return (unsigned char)byte;
+}
+
+// Copies the frame to the drawing target in one pass: a plain copy when the
+// clip rectangle is the whole screen and the origin is 0, otherwise the part
+// of each bank row inside both the clip rectangle and the frame, moved by the
+// origin. Pixels around the frame are left alone.
+static void copy_out(const LCD_Tilemap *tilemap) {
+    unsigned char *target = LCD_GetTarget(), *dst, mask;
+    int b, x, x1, y1, x2, y2, ox, oy;
+
+    LCD_GetClip(&x1, &y1, &x2, &y2);
+    LCD_GetOrigin(&ox, &oy);
+    if (!ox && !oy && x1 == 0 && y1 == 0 && x2 == LCD_WIDTH - 1 && y2 == LCD_HEIGHT - 1) {
+        memcpy(target, tilemap->frame, sizeof(LCD_Buffer));
+        return;
+    }
+    // the frame covers 0, 0 to LCD_WIDTH - 1, LCD_HEIGHT - 1 in drawing coordinates
+    if (x1 < 0) x1 = 0;
+    if (y1 < 0) y1 = 0;
+    if (x2 > LCD_WIDTH - 1) x2 = LCD_WIDTH - 1;
+    if (y2 > LCD_HEIGHT - 1) y2 = LCD_HEIGHT - 1;
+    if (x1 > x2 || y1 > y2) return;
+
+    // in target coordinates from now on
+    x1 += ox;
+    x2 += ox;
+    y1 += oy;
+    y2 += oy;
+    for (b = y1 / 8; b <= y2 / 8; ++b) {
+        mask = 0xFF;
+        if (y1 > b * 8) mask &= 0xFF << (y1 - b * 8);
+        if (y2 < b * 8 + 7) mask &= 0xFF >> (b * 8 + 7 - y2);
+        dst = target + b * LCD_WIDTH;
+        if (mask == 0xFF && !(oy & 7)) {
+            memcpy(dst + x1, tilemap->frame + (b - oy / 8) * LCD_WIDTH + x1 - ox, x2 - x1 + 1);
+            continue;
+        }
+        for (x = x1; x <= x2; ++x) {
+            dst[x] = (dst[x] & ~mask) | (frame_byte(tilemap->frame, x - ox, b * 8 - oy) & mask);
+        }
+    }
+}
+
+void LCD_TilemapInit(LCD_Tilemap *tilemap, const unsigned char *tileset,
+                     const unsigned char *map, int width, int height) {
+    memset(tilemap, 0, sizeof(LCD_Tilemap));
+    tilemap->tileset = tileset;
+    tilemap->map = map;
+    tilemap->width = width > 0 ? width : 1;
+    tilemap->height = height > 0 ? height : 1;
+    tilemap->dirty_lo = LCD_WIDTH;
+    tilemap->dirty_hi = -1;
+}
+
+void LCD_TilemapCamera(LCD_Tilemap *tilemap, int x, int y) {
+    tilemap->x = x;
+    tilemap->y = y;
+}
+
+// to call after changing the tile at (tx, ty) in the map: every frame column
+// showing that tile column is redrawn on the next render
+void LCD_TilemapInvalidate(LCD_Tilemap *tilemap, int tx, int ty) {
+    int x, x1, x2, period = tilemap->width * LCD_TILE_SIZE;
+    (void)ty;
+    if (!tilemap->valid) return;
+    // the map may wrap within the screen, so the tile can show several times
+    x = wrap(tx * LCD_TILE_SIZE - tilemap->drawn_x, period);
+    for (x -= period; x < LCD_WIDTH; x += period) {
+        x1 = x < 0 ? 0 : x;
+        x2 = x + LCD_TILE_SIZE - 1 >= LCD_WIDTH ? LCD_WIDTH - 1 : x + LCD_TILE_SIZE - 1;
+        if (x1 > x2) continue;
+        if (x1 < tilemap->dirty_lo) tilemap->dirty_lo = x1;
+        if (x2 > tilemap->dirty_hi) tilemap->dirty_hi = x2;
+    }
+}
+
+void LCD_TilemapRender(LCD_Tilemap *tilemap) {
+    int b, dx = tilemap->x - tilemap->drawn_x;
+    unsigned char *row;
+
+    if (!tilemap->valid || tilemap->y != tilemap->drawn_y || dx >= LCD_WIDTH || dx <= -LCD_WIDTH) {
+        // vertical moves shift every bank row, start over
+        render_columns(tilemap, 0, LCD_WIDTH - 1);
+    }
+    else if (dx) {
+        // slide what is still visible, draw the exposed columns
+        for (b = 0; b < LCD_BANKS; ++b) {
+            row = tilemap->frame + b * LCD_WIDTH;
+            if (dx > 0) memmove(row, row + dx, LCD_WIDTH - dx);
+            else memmove(row - dx, row, LCD_WIDTH + dx);
+        }
+        if (dx > 0) render_columns(tilemap, LCD_WIDTH - dx, LCD_WIDTH - 1);
+        else render_columns(tilemap, 0, -dx - 1);
+        // pending tile updates moved along
+        tilemap->dirty_lo -= dx;
+        tilemap->dirty_hi -= dx;
+    }
+    if (tilemap->valid && tilemap->y == tilemap->drawn_y) {
+        if (tilemap->dirty_lo < 0) tilemap->dirty_lo = 0;
+        if (tilemap->dirty_hi >= LCD_WIDTH) tilemap->dirty_hi = LCD_WIDTH - 1;
+        if (tilemap->dirty_lo <= tilemap->dirty_hi)
+            render_columns(tilemap, tilemap->dirty_lo, tilemap->dirty_hi);
+    }
+    tilemap->dirty_lo = LCD_WIDTH;
+    tilemap->dirty_hi = -1;
+    tilemap->drawn_x = tilemap->x;
+    tilemap->drawn_y = tilemap->y;
+    tilemap->valid = 1;
+
+    copy_out(tilemap);
+}
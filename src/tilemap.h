@@ -0,0 +1,35 @@
+#ifndef TILEMAP_H
+#define TILEMAP_H
+
+#include "lcd.h"
+
+// Tilemap of 8x8 tiles with a fine scrolling camera.
+// A tile is 8 bytes in LCD_Buffer layout, so a tile column is one byte of a
+// bank row: aligned rows are plain copies and other offsets combine two tiles
+// with a shift. The map wraps around in both directions.
+// The map is rendered in its own frame, updated incrementally as the camera
+// moves, then copied to the drawing target so sprites can go on top. The copy
+// starts at the origin and stays in the clip rectangle; it is written to
+// LCD_GetTarget() directly, which must be a whole screen target.
+
+#define LCD_TILE_SIZE 8
+
+typedef struct {
+    const unsigned char *tileset; // LCD_TILE_SIZE bytes per tile
+    const unsigned char *map; // width * height tile indices, row by row
+    int width, height; // in tiles
+    int x, y; // camera, top left corner in pixels
+
+    int drawn_x, drawn_y; // camera of the frame
+    int valid; // frame matches drawn_x, drawn_y
+    int dirty_lo, dirty_hi; // frame columns to redraw
+    LCD_Buffer frame;
+} LCD_Tilemap;
+
+void LCD_TilemapInit(LCD_Tilemap *tilemap, const unsigned char *tileset,
+                     const unsigned char *map, int width, int height);
+void LCD_TilemapCamera(LCD_Tilemap *tilemap, int x, int y);
+void LCD_TilemapInvalidate(LCD_Tilemap *tilemap, int tx, int ty);
+void LCD_TilemapRender(LCD_Tilemap *tilemap);
+
+#endif
@@ -0,0 +1,284 @@
+#include "transform.h"
+
+// sin(0..90 degrees), 16.16 fixed point
+static const int LCD_sin_table[91] = {
+    0, 1144, 2287, 3430, 4572, 5712, 6850, 7987, 9121, 10252,
+    11380, 12505, 13626, 14742, 15855, 16962, 18064, 19161, 20252, 21336,
+    22415, 23486, 24550, 25607, 26656, 27697, 28729, 29753, 30767, 31772,
+    32768, 33754, 34729, 35693, 36647, 37590, 38521, 39441, 40348, 41243,
+    42126, 42995, 43852, 44695, 45525, 46341, 47143, 47930, 48703, 49461,
+    50203, 50931, 51643, 52339, 53020, 53684, 54332, 54963, 55578, 56175,
+    56756, 57319, 57865, 58393, 58903, 59396, 59870, 60326, 60764, 61183,
+    61584, 61966, 62328, 62672, 62997, 63303, 63589, 63856, 64104, 64332,
+    64540, 64729, 64898, 65048, 65177, 65287, 65376, 65446, 65496, 65526,
+    65536,
+};
+
+LCD_Fixed LCD_Sin(int angle) {
+    angle %= 360;
+    if (angle < 0) angle += 360;
+    if (angle <= 90) return LCD_sin_table[angle];
+    if (angle <= 180) return LCD_sin_table[180 - angle];
+    if (angle <= 270) return -LCD_sin_table[angle - 180];
+    return -LCD_sin_table[360 - angle];
+}
+
+LCD_Fixed LCD_Cos(int angle) {
+    return LCD_Sin(angle % 360 + 90);
+}
+
+// round to nearest, halves away from zero
+static int round_fixed(long long value) {
+    return value < 0 ? -(int)((-value + LCD_FIXED_ONE / 2) >> 16)
+                     : (int)((value + LCD_FIXED_ONE / 2) >> 16);
+}
+
+static LCD_Fixed mul(LCD_Fixed a, LCD_Fixed b) {
+    return (LCD_Fixed)(((long long)a * b) >> 16);
+}
+
+void LCD_Polar(int x, int y, int length, int angle, int *px, int *py) {
+    *px = x + round_fixed((long long)length * LCD_Cos(angle));
+    *py = y - round_fixed((long long)length * LCD_Sin(angle));
+}
+
+void LCD_TransformIdentity(LCD_Transform *t) {
+    t->a = t->d = LCD_FIXED_ONE;
+    t->b = t->c = 0;
+    t->tx = t->ty = 0;
+}
+
+void LCD_TransformMultiply(LCD_Transform *result, const LCD_Transform *m, const LCD_Transform *n) {
+    LCD_Transform r;
+    r.a = mul(m->a, n->a) + mul(m->b, n->c);
+    r.b = mul(m->a, n->b) + mul(m->b, n->d);
+    r.c = mul(m->c, n->a) + mul(m->d, n->c);
+    r.d = mul(m->c, n->b) + mul(m->d, n->d);
+    r.tx = mul(m->a, n->tx) + mul(m->b, n->ty) + m->tx;
+    r.ty = mul(m->c, n->tx) + mul(m->d, n->ty) + m->ty;
+    *result = r;
+}
+
+void LCD_TransformTranslate(LCD_Transform *t, int dx, int dy) {
+    t->tx += t->a * dx + t->b * dy;
+    t->ty += t->c * dx + t->d * dy;
+}
+
+// counter-clockwise on screen, where y points down
+void LCD_TransformRotate(LCD_Transform *t, int angle) {
+    LCD_Transform r;
+    r.a = r.d = LCD_Cos(angle);
+    r.b = LCD_Sin(angle);
+    r.c = -r.b;
+    r.tx = r.ty = 0;
+    LCD_TransformMultiply(t, t, &r);
+}
+
+void LCD_TransformScale(LCD_Transform *t, LCD_Fixed sx, LCD_Fixed sy) {
+    t->a = mul(t->a, sx);
+    t->c = mul(t->c, sx);
+    t->b = mul(t->b, sy);
+    t->d = mul(t->d, sy);
+}
+
+int LCD_TransformInvert(LCD_Transform *inverse, const LCD_Transform *t) {
+    long long det = ((long long)t->a * t->d - (long long)t->b * t->c) >> 16;
+    LCD_Transform r;
+    if (det == 0) return 1;
+    r.a = (LCD_Fixed)(((long long)t->d << 16) / det);
+    r.b = (LCD_Fixed)(-((long long)t->b << 16) / det);
+    r.c = (LCD_Fixed)(-((long long)t->c << 16) / det);
+    r.d = (LCD_Fixed)(((long long)t->a << 16) / det);
+    r.tx = -(mul(r.a, t->tx) + mul(r.b, t->ty));
+    r.ty = -(mul(r.c, t->tx) + mul(r.d, t->ty));
+    *inverse = r;
+    return 0;
+}
+
+void LCD_TransformPoint(const LCD_Transform *t, int x, int y, int *px, int *py) {
+    *px = round_fixed((long long)t->a * x + (long long)t->b * y + t->tx);
+    *py = round_fixed((long long)t->c * x + (long long)t->d * y + t->ty);
+}
+
+static int floor_fixed(long long value) {
+    return (int)(value >> 16);
+}
+
+static void blend(unsigned char *dst, unsigned char src, unsigned char mask, LCD_COLOR mode) {
+    switch (mode & MODE) {
+    case WHITE: *dst &= ~src; break;
+    case BLACK:
+    case OR: *dst |= src; break;
+    case XOR: *dst ^= src; break;
+    case AND: *dst &= src | ~mask; break;
+    default: break;
+    }
+    if (mode & NOT) *dst ^= mask;
+}
+
+// Every screen pixel of the bounding box is mapped back to the bitmap through
+// the inverse transform, sampling at pixel centers. Columns are walked top to
+// bottom so that a bank byte is blended once, and the bitmap coordinates are
+// stepped incrementally: two additions per pixel.
+void LCD_BlitTransformed(const unsigned char *bitmap, int w, int h, const LCD_Transform *t, LCD_COLOR mode) {
+    unsigned char *buffer = LCD_GetTarget(), src, mask;
+    LCD_Transform inv;
+    long long cx[4], cy[4], minx, maxx, miny, maxy;
+    int x1, y1, x2, y2, x, y, i, cx1, cy1, cx2, cy2, ox, oy;
+    LCD_Fixed u, v;
+    unsigned int sx, sy;
+
+    if (w <= 0 || h <= 0 || LCD_TransformInvert(&inv, t)) return;
+
+    // bounding box of the transformed bitmap rectangle
+    for (i = 0; i < 4; ++i) {
+        long long bx = (i & 1) ? w : 0, by = (i & 2) ? h : 0;
+        cx[i] = t->a * bx + t->b * by + t->tx;
+        cy[i] = t->c * bx + t->d * by + t->ty;
+    }
+    minx = maxx = cx[0];
+    miny = maxy = cy[0];
+    for (i = 1; i < 4; ++i) {
+        if (cx[i] < minx) minx = cx[i];
+        if (cx[i] > maxx) maxx = cx[i];
+        if (cy[i] < miny) miny = cy[i];
+        if (cy[i] > maxy) maxy = cy[i];
+    }
+    x1 = floor_fixed(minx);
+    y1 = floor_fixed(miny);
+    x2 = floor_fixed(maxx);
+    y2 = floor_fixed(maxy);
+    LCD_GetClip(&cx1, &cy1, &cx2, &cy2);
+    LCD_GetOrigin(&ox, &oy);
+    if (x1 < cx1) x1 = cx1;
+    if (y1 < cy1) y1 = cy1;
+    if (x2 > cx2) x2 = cx2;
+    if (y2 > cy2) y2 = cy2;
+    if (x1 > x2 || y1 > y2) return;
+
+    // sampling in local coordinates, writing at the origin
+    for (x = x1; x <= x2; ++x) {
+        u = (LCD_Fixed)((inv.a * (2LL * x + 1) >> 1) + (inv.b * (2LL * y1 + 1) >> 1) + inv.tx);
+        v = (LCD_Fixed)((inv.c * (2LL * x + 1) >> 1) + (inv.d * (2LL * y1 + 1) >> 1) + inv.ty);
+        src = mask = 0;
+        for (y = y1 + oy; y <= y2 + oy; ++y) {
+            sx = (unsigned int)(u >> 16);
+            sy = (unsigned int)(v >> 16);
+            if (sx < (unsigned int)w && sy < (unsigned int)h) {
+                mask |= 1 << (y & 7);
+                if (bitmap[sx + (sy >> 3) * w] & (1 << (sy & 7)))
+                    src |= 1 << (y & 7);
+            }
+            if ((y & 7) == 7 || y == y2 + oy) {
+                if (mask) blend(&buffer[x + ox + (y >> 3) * LCD_WIDTH], src, mask, mode);
+                src = mask = 0;
+            }
+            u += inv.b;
+            v += inv.d;
+        }
+    }
+}
+
+void LCD_BlitRotated(const unsigned char *bitmap, int w, int h, int x, int y, int angle, LCD_Fixed scale, LCD_COLOR mode) {
+    LCD_Transform t;
+    LCD_TransformIdentity(&t);
+    t.tx = x << 16;
+    t.ty = y << 16;
+    LCD_TransformRotate(&t, angle);
+    LCD_TransformScale(&t, scale, scale);
+    t.tx -= (t.a * w + t.b * h) / 2;
+    t.ty -= (t.c * w + t.d * h) / 2;
+    LCD_BlitTransformed(bitmap, w, h, &t, mode);
+}
+
+// 8x8 bit matrix transpose: bit j of byte i moves to bit i of byte j
+static unsigned long long transpose8(unsigned long long x) {
+    unsigned long long t;
+    t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+    x ^= t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+    x ^= t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+    x ^= t ^ (t << 28);
+    return x;
+}
+
+static unsigned char reverse8(unsigned char b) {
+    b = (unsigned char)((b & 0xF0) >> 4 | (b & 0x0F) << 4);
+    b = (unsigned char)((b & 0xCC) >> 2 | (b & 0x33) << 2);
+    b = (unsigned char)((b & 0xAA) >> 1 | (b & 0x55) << 1);
+    return b;
+}
+
+// Quarter turns work on 8x8 blocks: the 8 column bytes of a source bank become
+// 8 row bytes once transposed, which are the columns of the turned bitmap.
+// Gathering source columns in reverse order mirrors the result vertically.
+static void orient_block(unsigned char *dst, const unsigned char *src, int w, int h,
+                         int mirror_x, int mirror_y) {
+    int banks = (h + 7) / 8, dbanks = (w + 7) / 8;
+    int bank, dbank, i, j, column, dx;
+    unsigned long long block;
+
+    for (bank = 0; bank < banks; ++bank) {
+        for (dbank = 0; dbank < dbanks; ++dbank) {
+            block = 0;
+            for (i = 0; i < 8; ++i) {
+                column = mirror_y ? w - 1 - dbank * 8 - i : dbank * 8 + i;
+                if (column >= 0 && column < w)
+                    block |= (unsigned long long)src[column + bank * w] << (8 * i);
+            }
+            block = transpose8(block);
+            for (j = 0; j < 8 && bank * 8 + j < h; ++j) {
+                dx = mirror_x ? h - 1 - bank * 8 - j : bank * 8 + j;
+                dst[dx + dbank * h] = (unsigned char)(block >> (8 * j));
+            }
+        }
+    }
+}
+
+// A column read bottom up is its bytes in reverse order with their bits
+// reversed, shifted down by the padding of the last bank.
+static void flip_columns(unsigned char *dst, const unsigned char *src, int w, int h, int mirror_x) {
+    int banks = (h + 7) / 8, pad = banks * 8 - h, x, k, sx;
+    unsigned int lo, hi;
+
+    for (x = 0; x < w; ++x) {
+        sx = mirror_x ? w - 1 - x : x;
+        for (k = 0; k < banks; ++k) {
+            lo = reverse8(src[sx + (banks - 1 - k) * w]);
+            hi = k + 1 < banks ? reverse8(src[sx + (banks - 2 - k) * w]) : 0;
+            dst[x + k * w] = (unsigned char)((lo | hi << 8) >> pad);
+        }
+    }
+}
+
+void LCD_BitmapOrient(unsigned char *dst, const unsigned char *src, int w, int h, LCD_ORIENTATION orientation) {
+    int banks = (h + 7) / 8, x, k;
+
+    switch (orientation) {
+    case LCD_ROTATE_90:
+        orient_block(dst, src, w, h, 0, 1);
+        break;
+    case LCD_ROTATE_270:
+        orient_block(dst, src, w, h, 1, 0);
+        break;
+    case LCD_TRANSPOSE:
+        orient_block(dst, src, w, h, 0, 0);
+        break;
+    case LCD_ROTATE_180:
+        flip_columns(dst, src, w, h, 1);
+        break;
+    case LCD_FLIP_Y:
+        flip_columns(dst, src, w, h, 0);
+        break;
+    case LCD_FLIP_X:
+        for (k = 0; k < banks; ++k)
+            for (x = 0; x < w; ++x)
+                dst[x + k * w] = src[w - 1 - x + k * w];
+        break;
+    default:
+        for (k = 0; k < banks * w; ++k)
+            dst[k] = src[k];
+        break;
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include "lcd.h"
+
+// Fixed-point trigonometry, 2D affine transforms and transformed blits.
+// Values are 16.16 fixed point. Angles are in degrees, 0 pointing right and
+// increasing counter-clockwise on screen, as in shape.h.
+//
+// A transform maps bitmap coordinates to screen coordinates. Operations are
+// applied to the bitmap side, so to spin a sprite around its center:
+//
+//     LCD_TransformIdentity(&t);
+//     LCD_TransformTranslate(&t, 42, 24);           // center on screen
+//     LCD_TransformRotate(&t, angle);
+//     LCD_TransformTranslate(&t, -w / 2, -h / 2);   // center of the sprite
+//     LCD_BlitTransformed(sprite, w, h, &t, OR);
+
+typedef int LCD_Fixed;
+
+#define LCD_FIXED_ONE 65536
+#define LCD_FIXED(n) ((LCD_Fixed)((n) * LCD_FIXED_ONE))
+
+typedef struct {
+    // x' = a x + b y + tx, y' = c x + d y + ty
+    LCD_Fixed a, b, c, d;
+    LCD_Fixed tx, ty;
+} LCD_Transform;
+
+// Exact bitmap rotations, counter-clockwise, and flips. Quarter turns and the
+// transpose swap width and height: the result is h pixels wide and w high.
+// Drawing a portrait frame (w = 48, h = 84) and rotating it by a quarter turn
+// gives a screen buffer for a panel mounted sideways.
+typedef enum {
+    LCD_ROTATE_0,
+    LCD_ROTATE_90,
+    LCD_ROTATE_180,
+    LCD_ROTATE_270,
+    LCD_FLIP_X,    // mirror left to right
+    LCD_FLIP_Y,    // mirror top to bottom
+    LCD_TRANSPOSE  // mirror along the top-left to bottom-right diagonal
+} LCD_ORIENTATION;
+
+LCD_Fixed LCD_Sin(int angle);
+LCD_Fixed LCD_Cos(int angle);
+// end of a clock hand of the given length starting at (x, y)
+void LCD_Polar(int x, int y, int length, int angle, int *px, int *py);
+
+void LCD_TransformIdentity(LCD_Transform *t);
+void LCD_TransformTranslate(LCD_Transform *t, int dx, int dy);
+void LCD_TransformRotate(LCD_Transform *t, int angle);
+void LCD_TransformScale(LCD_Transform *t, LCD_Fixed sx, LCD_Fixed sy);
+void LCD_TransformMultiply(LCD_Transform *result, const LCD_Transform *m, const LCD_Transform *n);
+int LCD_TransformInvert(LCD_Transform *inverse, const LCD_Transform *t);
+void LCD_TransformPoint(const LCD_Transform *t, int x, int y, int *px, int *py);
+
+// Bitmaps are in LCD_Buffer layout: w bytes per bank row, (h + 7) / 8 rows.
+// XOR, OR and AND blend as in LCD_Blit, BLACK and WHITE paint the set pixels.
+void LCD_BlitTransformed(const unsigned char *bitmap, int w, int h, const LCD_Transform *t, LCD_COLOR mode);
+void LCD_BlitRotated(const unsigned char *bitmap, int w, int h, int x, int y, int angle, LCD_Fixed scale, LCD_COLOR mode);
+
+// dst must not overlap src
+void LCD_BitmapOrient(unsigned char *dst, const unsigned char *src, int w, int h, LCD_ORIENTATION orientation);
+
+#endif
@@ -0,0 +1,192 @@
+#include "tween.h"
+
+#define EASE_STEPS 64
+
+// easing curves sampled at t = i / 64, interpolated in between
+static const int LCD_ease_table[LCD_EASE_COUNT][EASE_STEPS + 1] = {
+    { // linear
+        0, 1024, 2048, 3072, 4096, 5120, 6144, 7168,
+        8192, 9216, 10240, 11264, 12288, 13312, 14336, 15360,
+        16384, 17408, 18432, 19456, 20480, 21504, 22528, 23552,
+        24576, 25600, 26624, 27648, 28672, 29696, 30720, 31744,
+        32768, 33792, 34816, 35840, 36864, 37888, 38912, 39936,
+        40960, 41984, 43008, 44032, 45056, 46080, 47104, 48128,
+        49152, 50176, 51200, 52224, 53248, 54272, 55296, 56320,
+        57344, 58368, 59392, 60416, 61440, 62464, 63488, 64512,
+        65536,
+    },
+    { // in
+        0, 0, 2, 7, 16, 31, 54, 86,
+        128, 182, 250, 333, 432, 549, 686, 844,
+        1024, 1228, 1458, 1715, 2000, 2315, 2662, 3042,
+        3456, 3906, 4394, 4921, 5488, 6097, 6750, 7448,
+        8192, 8984, 9826, 10719, 11664, 12663, 13718, 14830,
+        16000, 17230, 18522, 19877, 21296, 22781, 24334, 25956,
+        27648, 29412, 31250, 33163, 35152, 37219, 39366, 41594,
+        43904, 46298, 48778, 51345, 54000, 56745, 59582, 62512,
+        65536,
+    },
+    { // out
+        0, 3024, 5954, 8791, 11536, 14191, 16758, 19238,
+        21632, 23942, 26170, 28317, 30384, 32373, 34286, 36124,
+        37888, 39580, 41202, 42755, 44240, 45659, 47014, 48306,
+        49536, 50706, 51818, 52873, 53872, 54817, 55710, 56552,
+        57344, 58088, 58786, 59439, 60048, 60615, 61142, 61630,
+        62080, 62494, 62874, 63221, 63536, 63821, 64078, 64308,
+        64512, 64692, 64850, 64987, 65104, 65203, 65286, 65354,
+        65408, 65450, 65482, 65505, 65520, 65529, 65534, 65536,
+        65536,
+    },
+    { // in out
+        0, 1, 8, 27, 64, 125, 216, 343,
+        512, 729, 1000, 1331, 1728, 2197, 2744, 3375,
+        4096, 4913, 5832, 6859, 8000, 9261, 10648, 12167,
+        13824, 15625, 17576, 19683, 21952, 24389, 27000, 29791,
+        32768, 35745, 38536, 41147, 43584, 45853, 47960, 49911,
+        51712, 53369, 54888, 56275, 57536, 58677, 59704, 60623,
+        61440, 62161, 62792, 63339, 63808, 64205, 64536, 64807,
+        65024, 65193, 65320, 65411, 65472, 65509, 65528, 65535,
+        65536,
+    },
+    { // back
+        0, 4713, 9224, 13539, 17662, 21595, 25344, 28913,
+        32304, 35524, 38575, 41461, 44187, 46757, 49175, 51444,
+        53570, 55555, 57404, 59122, 60711, 62177, 63523, 64753,
+        65871, 66882, 67789, 68597, 69309, 69929, 70463, 70913,
+        71283, 71579, 71803, 71960, 72054, 72089, 72070, 71999,
+        71881, 71721, 71521, 71288, 71023, 70732, 70418, 70086,
+        69739, 69382, 69019, 68653, 68289, 67931, 67583, 67249,
+        66933, 66638, 66370, 66132, 65928, 65763, 65639, 65563,
+        65536,
+    },
+    { // bounce
+        0, 121, 484, 1089, 1936, 3025, 4356, 5929,
+        7744, 9801, 12100, 14641, 17424, 20449, 23716, 27225,
+        30976, 34969, 39204, 43681, 48400, 53361, 58564, 64009,
+        63552, 61033, 58756, 56721, 54928, 53377, 52068, 51001,
+        50176, 49593, 49252, 49153, 49296, 49681, 50308, 51177,
+        52288, 53641, 55236, 57073, 59152, 61473, 64036, 64921,
+        63744, 62809, 62116, 61665, 61456, 61489, 61764, 62281,
+        63040, 64041, 65284, 65041, 64656, 64513, 64612, 64953,
+        65536,
+    },
+};
+
+LCD_Fixed LCD_Ease(LCD_EASE ease, LCD_Fixed t) {
+    const int *table;
+    int i, frac;
+    if ((unsigned)ease >= LCD_EASE_COUNT) ease = LCD_EASE_LINEAR;
+    if (t <= 0) return 0;
+    if (t >= LCD_FIXED_ONE) return LCD_FIXED_ONE;
+    table = LCD_ease_table[ease];
+    i = t >> 10;
+    frac = t & 0x3FF;
+    return table[i] + (((table[i + 1] - table[i]) * frac) >> 10);
+}
+
+void LCD_TweenInit(LCD_Tweens *pool) {
+    pool->count = 0;
+}
+
+int LCD_TweenAdd(LCD_Tweens *pool, int object, int *target, int from, int to,
+                 int duration_ms, LCD_EASE ease, LCD_TWEEN_MODE mode) {
+    int i = pool->count;
+    if (i == LCD_TWEEN_MAX || (unsigned)object >= LCD_TWEEN_OBJECTS) return -1;
+    if (duration_ms < 1) duration_ms = 1;
+    pool->target[i] = target;
+    pool->from[i] = (short)from;
+    pool->to[i] = (short)to;
+    pool->elapsed[i] = 0;
+    pool->duration[i] = duration_ms;
+    pool->inverse[i] = (unsigned int)(((1ULL << 31) + duration_ms - 1) / duration_ms);
+    pool->ease[i] = (unsigned char)ease;
+    pool->mode[i] = (unsigned char)mode;
+    pool->object[i] = (unsigned char)object;
+    *target = from;
+    return pool->count++;
+}
+
+void LCD_TweenSeek(LCD_Tweens *pool, int tween, int elapsed_ms) {
+    unsigned int period;
+    if (tween < 0 || tween >= pool->count || elapsed_ms < 0) return;
+    period = pool->duration[tween] * (pool->mode[tween] == LCD_TWEEN_PINGPONG ? 2 : 1);
+    pool->elapsed[tween] = pool->mode[tween] == LCD_TWEEN_ONCE ? (unsigned int)elapsed_ms : elapsed_ms % period;
+}
+
+// the last tween takes the place of the removed one
+static void remove_tween(LCD_Tweens *pool, int i) {
+    int last = --pool->count;
+    pool->target[i] = pool->target[last];
+    pool->from[i] = pool->from[last];
+    pool->to[i] = pool->to[last];
+    pool->elapsed[i] = pool->elapsed[last];
+    pool->duration[i] = pool->duration[last];
+    pool->inverse[i] = pool->inverse[last];
+    pool->ease[i] = pool->ease[last];
+    pool->mode[i] = pool->mode[last];
+    pool->object[i] = pool->object[last];
+}
+
+void LCD_TweenStop(LCD_Tweens *pool, int object) {
+    int i = 0;
+    while (i < pool->count) {
+        if (pool->object[i] == object) remove_tween(pool, i);
+        else ++i;
+    }
+}
+
+int LCD_TweenUpdate(LCD_Tweens *pool, int dt_ms, unsigned char *changed) {
+    unsigned int marks[LCD_TWEEN_OBJECTS / 32] = { 0 }, word, elapsed, duration;
+    LCD_Fixed t[LCD_TWEEN_MAX], eased;
+    int i, n = 0, value, done = 0;
+
+    if (dt_ms < 0) dt_ms = 0;
+
+    // progress along the curve, from the time within the period
+    for (i = 0; i < pool->count; ++i) {
+        elapsed = pool->elapsed[i] + dt_ms;
+        duration = pool->duration[i];
+        switch (pool->mode[i]) {
+        case LCD_TWEEN_LOOP:
+            elapsed %= duration;
+            break;
+        case LCD_TWEEN_PINGPONG:
+            elapsed %= 2 * duration;
+            break;
+        default:
+            if (elapsed >= duration) {
+                elapsed = duration;
+                done = 1;
+            }
+            break;
+        }
+        pool->elapsed[i] = elapsed;
+        if (elapsed > duration) elapsed = 2 * duration - elapsed;
+        t[i] = (LCD_Fixed)(((unsigned long long)elapsed * pool->inverse[i]) >> 15);
+    }
+
+    // eased values, rounded to pixels
+    for (i = 0; i < pool->count; ++i) {
+        eased = LCD_Ease(pool->ease[i], t[i]);
+        value = pool->from[i] + (int)(((long long)(pool->to[i] - pool->from[i]) * eased + LCD_FIXED_ONE / 2) >> 16);
+        if (value != *pool->target[i]) {
+            *pool->target[i] = value;
+            marks[pool->object[i] / 32] |= 1u << (pool->object[i] % 32);
+        }
+    }
+
+    if (done) {
+        i = 0;
+        while (i < pool->count) {
+            if (pool->mode[i] == LCD_TWEEN_ONCE && pool->elapsed[i] == pool->duration[i]) remove_tween(pool, i);
+            else ++i;
+        }
+    }
+
+    for (i = 0; i < LCD_TWEEN_OBJECTS / 32; ++i) {
+        for (word = marks[i]; word; word &= word - 1) {
+            changed[n++] = (unsigned char)(i * 32 + __builtin_ctz(word));
+        }
+    }
+    return n;
+}
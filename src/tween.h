@@ -0,0 +1,70 @@
+#ifndef TWEEN_H
+#define TWEEN_H
+
+#include "lcd.h"
+#include "transform.h"
+
+// Tweens move an integer (a position, a size, a scroll offset) from one value
+// to another along an easing curve. They are kept in a pool as a structure of
+// arrays and advanced together by one call per frame, in 16.16 fixed point
+// with easing curves read from tables. Each tween belongs to an object, and
+// the update reports the objects of which a value changed once rounded to a
+// pixel: the others need no redraw.
+//
+//     LCD_TweenAdd(&pool, id, &sprite[id].x, 0, 60, 500, LCD_EASE_OUT, LCD_TWEEN_ONCE);
+//     n = LCD_TweenUpdate(&pool, frame_ms, changed);
+//     for (i = 0; i < n; ++i) redraw(changed[i]);
+
+#define LCD_TWEEN_MAX 64
+#define LCD_TWEEN_OBJECTS 256 // object ids are 0..255
+
+typedef enum {
+    LCD_EASE_LINEAR = 0,
+    LCD_EASE_IN, // cubic
+    LCD_EASE_OUT,
+    LCD_EASE_IN_OUT,
+    LCD_EASE_BACK, // overshoots the end, then settles
+    LCD_EASE_BOUNCE, // bounces on the end
+    LCD_EASE_COUNT
+} LCD_EASE;
+
+typedef enum {
+    LCD_TWEEN_ONCE = 0, // removed once the end is reached
+    LCD_TWEEN_LOOP, // starts over from the beginning
+    LCD_TWEEN_PINGPONG // goes back and forth
+} LCD_TWEEN_MODE;
+
+typedef struct {
+    int count;
+    int *target[LCD_TWEEN_MAX]; // rounded value, written when it changes
+    short from[LCD_TWEEN_MAX], to[LCD_TWEEN_MAX];
+    unsigned int elapsed[LCD_TWEEN_MAX]; // ms, within the current period
+    unsigned int duration[LCD_TWEEN_MAX]; // ms
+    unsigned int inverse[LCD_TWEEN_MAX]; // 2^31 / duration, rounded up
+    unsigned char ease[LCD_TWEEN_MAX];
+    unsigned char mode[LCD_TWEEN_MAX];
+    unsigned char object[LCD_TWEEN_MAX];
+} LCD_Tweens;
+
+// eased progress, t from 0 to LCD_FIXED_ONE
+LCD_Fixed LCD_Ease(LCD_EASE ease, LCD_Fixed t);
+
+void LCD_TweenInit(LCD_Tweens *pool);
+
+// Sets the target to from, returns the index of the tween or -1 when the pool
+// is full. Indexes stay valid until a tween is removed.
+int LCD_TweenAdd(LCD_Tweens *pool, int object, int *target, int from, int to,
+                 int duration_ms, LCD_EASE ease, LCD_TWEEN_MODE mode);
+
+// starts a tween further along, e.g. to desynchronize looping ones
+void LCD_TweenSeek(LCD_Tweens *pool, int tween, int elapsed_ms);
+
+// removes the tweens of an object, leaving its values where they are
+void LCD_TweenStop(LCD_Tweens *pool, int object);
+
+// Advances every tween by dt_ms and writes the new values. The ids of the
+// objects with a changed value are stored in changed, in increasing order and
+// at most once each; returns their number.
+int LCD_TweenUpdate(LCD_Tweens *pool, int dt_ms, unsigned char *changed);
+
+#endif
@@ -0,0 +1,330 @@
+#include <string.h>
+#include "ui.h"
+#include "font.h"
+
+#define LCD_BANKS (LCD_HEIGHT / 8)
+#define ROW_HEIGHT (LCD_CHAR_HEIGHT + 1)
+
+typedef struct {
+    int used;
+    LCD_WIDGET_TYPE type;
+    LCD_Widget parent, child, next;
+    int x, y, w, h;
+    int visible, inverted, border;
+    int value, max;
+    const char **items;
+    int count;
+    char text[LCD_UI_TEXT];
+} Node;
+
+static Node nodes[LCD_UI_MAX_WIDGETS];
+
+// invalid column range of every bank row, and what the last render repainted
+static int dirty_lo[LCD_BANKS], dirty_hi[LCD_BANKS];
+static int painted_lo[LCD_BANKS], painted_hi[LCD_BANKS];
+
+// widgets are painted here, then only the invalid spans are copied out
+static LCD_Buffer scratch;
+
+static int valid(LCD_Widget widget) {
+    return widget >= 0 && widget < LCD_UI_MAX_WIDGETS && nodes[widget].used;
+}
+
+static void bounds(LCD_Widget widget, int *x1, int *y1, int *x2, int *y2) {
+    int x = 0, y = 0;
+    LCD_Widget w;
+    for (w = widget; w >= 0; w = nodes[w].parent) {
+        x += nodes[w].x;
+        y += nodes[w].y;
+    }
+    *x1 = x;
+    *y1 = y;
+    *x2 = x + nodes[widget].w - 1;
+    *y2 = y + nodes[widget].h - 1;
+}
+
+static void invalidate_rect(int x1, int y1, int x2, int y2) {
+    int b;
+    x1 = x1 < 0 ? 0 : x1;
+    y1 = y1 < 0 ? 0 : y1;
+    x2 = x2 >= LCD_WIDTH ? LCD_WIDTH - 1 : x2;
+    y2 = y2 >= LCD_HEIGHT ? LCD_HEIGHT - 1 : y2;
+    if (x1 > x2 || y1 > y2) return;
+    for (b = y1 / 8; b <= y2 / 8; ++b) {
+        if (x1 < dirty_lo[b]) dirty_lo[b] = x1;
+        if (x2 > dirty_hi[b]) dirty_hi[b] = x2;
+    }
+}
+
+void LCD_UIInvalidate(LCD_Widget widget) {
+    int x1, y1, x2, y2;
+    if (!valid(widget)) return;
+    bounds(widget, &x1, &y1, &x2, &y2);
+    invalidate_rect(x1, y1, x2, y2);
+}
+
+void LCD_UIInit() {
+    int b;
+    memset(nodes, 0, sizeof(nodes));
+    nodes[0].used = 1;
+    nodes[0].type = LCD_UI_BOX;
+    nodes[0].parent = nodes[0].child = nodes[0].next = -1;
+    nodes[0].w = LCD_WIDTH;
+    nodes[0].h = LCD_HEIGHT;
+    nodes[0].visible = 1;
+    for (b = 0; b < LCD_BANKS; ++b) {
+        dirty_lo[b] = painted_lo[b] = LCD_WIDTH;
+        dirty_hi[b] = painted_hi[b] = -1;
+    }
+    invalidate_rect(0, 0, LCD_WIDTH - 1, LCD_HEIGHT - 1);
+}
+
+LCD_Widget LCD_UIRoot() {
+    return 0;
+}
+
+static LCD_Widget create(LCD_Widget parent, LCD_WIDGET_TYPE type, int x, int y, int w, int h) {
+    LCD_Widget widget, last;
+    if (!valid(parent)) return -1;
+    for (widget = 1; widget < LCD_UI_MAX_WIDGETS && nodes[widget].used; ++widget);
+    if (widget == LCD_UI_MAX_WIDGETS) return -1;
+
+    memset(&nodes[widget], 0, sizeof(Node));
+    nodes[widget].used = 1;
+    nodes[widget].type = type;
+    nodes[widget].parent = parent;
+    nodes[widget].child = nodes[widget].next = -1;
+    nodes[widget].x = x;
+    nodes[widget].y = y;
+    nodes[widget].w = w;
+    nodes[widget].h = h;
+    nodes[widget].visible = 1;
+
+    // children are painted in creation order
+    if (nodes[parent].child < 0) nodes[parent].child = widget;
+    else {
+        for (last = nodes[parent].child; nodes[last].next >= 0; last = nodes[last].next);
+        nodes[last].next = widget;
+    }
+    LCD_UIInvalidate(widget);
+    return widget;
+}
+
+LCD_Widget LCD_UIBox(LCD_Widget parent, int x, int y, int w, int h, int border) {
+    LCD_Widget widget = create(parent, LCD_UI_BOX, x, y, w, h);
+    if (widget >= 0) nodes[widget].border = border;
+    return widget;
+}
+
+LCD_Widget LCD_UILabel(LCD_Widget parent, int x, int y, int w, int h, const char *text) {
+    LCD_Widget widget = create(parent, LCD_UI_LABEL, x, y, w, h);
+    if (widget >= 0 && text) strncpy(nodes[widget].text, text, LCD_UI_TEXT - 1);
+    return widget;
+}
+
+LCD_Widget LCD_UIProgress(LCD_Widget parent, int x, int y, int w, int h, int max) {
+    LCD_Widget widget = create(parent, LCD_UI_PROGRESS, x, y, w, h);
+    if (widget >= 0) nodes[widget].max = max > 0 ? max : 1;
+    return widget;
+}
+
+LCD_Widget LCD_UIMenu(LCD_Widget parent, int x, int y, int w, int h, const char **items, int count) {
+    LCD_Widget widget = create(parent, LCD_UI_MENU, x, y, w, h);
+    if (widget >= 0) {
+        nodes[widget].items = items;
+        nodes[widget].count = count;
+    }
+    return widget;
+}
+
+static void release(LCD_Widget widget) {
+    LCD_Widget child, next;
+    for (child = nodes[widget].child; child >= 0; child = next) {
+        next = nodes[child].next;
+        release(child);
+    }
+    nodes[widget].used = 0;
+}
+
+void LCD_UIRemove(LCD_Widget widget) {
+    LCD_Widget parent, *link;
+    if (!valid(widget) || widget == 0) return;
+    LCD_UIInvalidate(widget);
+    parent = nodes[widget].parent;
+    for (link = &nodes[parent].child; *link != widget; link = &nodes[*link].next);
+    *link = nodes[widget].next;
+    release(widget);
+}
+
+void LCD_UISetText(LCD_Widget widget, const char *text) {
+    if (!valid(widget) || !text || !strncmp(nodes[widget].text, text, LCD_UI_TEXT - 1)) return;
+    strncpy(nodes[widget].text, text, LCD_UI_TEXT - 1);
+    LCD_UIInvalidate(widget);
+}
+
+void LCD_UISetValue(LCD_Widget widget, int value) {
+    if (!valid(widget)) return;
+    if (nodes[widget].type == LCD_UI_PROGRESS) {
+        value = value < 0 ? 0 : (value > nodes[widget].max ? nodes[widget].max : value);
+    }
+    else if (nodes[widget].type == LCD_UI_MENU && nodes[widget].count) {
+        value = (value % nodes[widget].count + nodes[widget].count) % nodes[widget].count;
+    }
+    if (nodes[widget].value == value) return;
+    nodes[widget].value = value;
+    LCD_UIInvalidate(widget);
+}
+
+int LCD_UIGetValue(LCD_Widget widget) {
+    return valid(widget) ? nodes[widget].value : 0;
+}
+
+void LCD_UISetVisible(LCD_Widget widget, int visible) {
+    if (!valid(widget) || nodes[widget].visible == !!visible) return;
+    nodes[widget].visible = !!visible;
+    LCD_UIInvalidate(widget);
+}
+
+void LCD_UISetInverted(LCD_Widget widget, int inverted) {
+    if (!valid(widget) || nodes[widget].inverted == !!inverted) return;
+    nodes[widget].inverted = !!inverted;
+    LCD_UIInvalidate(widget);
+}
+
+void LCD_UIMove(LCD_Widget widget, int x, int y) {
+    if (!valid(widget) || (nodes[widget].x == x && nodes[widget].y == y)) return;
+    LCD_UIInvalidate(widget);
+    nodes[widget].x = x;
+    nodes[widget].y = y;
+    LCD_UIInvalidate(widget);
+}
+
+static void draw_text(const char *text, int x, int y, int w, LCD_COLOR mode) {
+    int n = (w + 1) / (LCD_CHAR_WIDTH + 1);
+    if (n <= 0) return;
+    LCD_TextMode(mode);
+    LCD_TextLocate(x, y);
+    LCD_TextN(text, n);
+}
+
+static void draw_menu(const Node *node, int x1, int y1, int x2) {
+    int rows = node->h / ROW_HEIGHT, first = 0, i, y;
+    if (node->value >= rows) first = node->value - rows + 1;
+    for (i = first; i < node->count && i < first + rows; ++i) {
+        y = y1 + (i - first) * ROW_HEIGHT;
+        if (i == node->value) {
+            LCD_FillRect(x1, y, x2, y + ROW_HEIGHT - 1, BLACK);
+            draw_text(node->items[i], x1 + 1, y + 1, x2 - x1, XOR);
+        }
+        else draw_text(node->items[i], x1 + 1, y + 1, x2 - x1, OR);
+    }
+}
+
+// paints the widgets of the tree meeting the invalid rectangle dx1, dy1, dx2, dy2
+static void draw(LCD_Widget widget, int dx1, int dy1, int dx2, int dy2) {
+    const Node *node = &nodes[widget];
+    LCD_COLOR ink = node->inverted ? WHITE : BLACK, paper = node->inverted ? BLACK : WHITE;
+    LCD_Widget child;
+    int x1, y1, x2, y2, fill, clipped;
+
+    if (!node->visible) return;
+    bounds(widget, &x1, &y1, &x2, &y2);
+    if (x1 <= dx2 && dx1 <= x2 && y1 <= dy2 && dy1 <= y2 && node->w > 0 && node->h > 0) {
+        // text and progress bars taller than the widget stay inside of it
+        clipped = !LCD_PushClip(x1, y1, x2, y2);
+        LCD_FillRect(x1, y1, x2, y2, paper);
+        switch (node->type) {
+        case LCD_UI_BOX:
+            if (node->border) LCD_DrawRect(x1, y1, x2, y2, ink);
+            break;
+        case LCD_UI_LABEL:
+            draw_text(node->text, x1 + 1, y1 + (node->h - LCD_CHAR_HEIGHT) / 2, node->w - 1,
+                      node->inverted ? XOR : OR);
+            break;
+        case LCD_UI_PROGRESS:
+            LCD_DrawRect(x1, y1, x2, y2, ink);
+            fill = (node->w - 4) * node->value / node->max;
+            if (fill > 0) LCD_FillRect(x1 + 2, y1 + 2, x1 + 1 + fill, y2 - 2, ink);
+            break;
+        case LCD_UI_MENU:
+            draw_menu(node, x1, y1, x2);
+            break;
+        }
+        if (clipped) LCD_PopClip();
+    }
+    for (child = node->child; child >= 0; child = nodes[child].next) {
+        draw(child, dx1, dy1, dx2, dy2);
+    }
+}
+
+// copies rows y1..y2 of columns x1..x2 of the scratch frame, in target coordinates
+static void copy_out(unsigned char *target, int x1, int y1, int x2, int y2) {
+    int b, x;
+    unsigned char mask, *dst, *src;
+    for (b = y1 / 8; b <= y2 / 8; ++b) {
+        mask = 0xFF;
+        if (y1 > b * 8) mask &= 0xFF << (y1 - b * 8);
+        if (y2 < b * 8 + 7) mask &= 0xFF >> (b * 8 + 7 - y2);
+        dst = target + b * LCD_WIDTH;
+        src = scratch + b * LCD_WIDTH;
+        if (mask == 0xFF) memcpy(dst + x1, src + x1, x2 - x1 + 1);
+        else for (x = x1; x <= x2; ++x) {
+            dst[x] = (dst[x] & ~mask) | (src[x] & mask);
+        }
+        if (x1 < painted_lo[b]) painted_lo[b] = x1;
+        if (x2 > painted_hi[b]) painted_hi[b] = x2;
+    }
+}
+
+// Repaints the invalid spans on the drawing target, returns how many there
+// were. The scratch frame is painted under the clip rectangle and origin of
+// the calling thread, like the target would be, and only the part of the
+// invalid spans inside the clip rectangle is copied. Bank rows sharing the
+// same span are painted together, clipped to it, so that only the invalid
+// rectangles are painted; with the clip stack full, the widgets meeting them
+// are painted whole, which the copy ignores.
+int LCD_UIRender() {
+    unsigned char *target = LCD_GetTarget();
+    int b, last, x1, y1, x2, y2, cx1, cy1, cx2, cy2, ox, oy, clipped, spans = 0;
+
+    for (b = 0; b < LCD_BANKS; ++b) {
+        if (dirty_lo[b] <= dirty_hi[b]) ++spans;
+    }
+    if (!spans) return 0;
+
+    LCD_SetTarget(scratch);
+    for (b = 0; b < LCD_BANKS; b = last + 1) {
+        last = b;
+        if (dirty_lo[b] > dirty_hi[b]) continue;
+        while (last + 1 < LCD_BANKS && dirty_lo[last + 1] == dirty_lo[b] && dirty_hi[last + 1] == dirty_hi[b]) ++last;
+        clipped = !LCD_PushClip(dirty_lo[b], b * 8, dirty_hi[b], last * 8 + 7);
+        draw(0, dirty_lo[b], b * 8, dirty_hi[b], last * 8 + 7);
+        if (clipped) LCD_PopClip();
+    }
+    LCD_SetTarget(target);
+
+    LCD_GetClip(&cx1, &cy1, &cx2, &cy2);
+    LCD_GetOrigin(&ox, &oy);
+    for (b = 0; b < LCD_BANKS; ++b) {
+        if (dirty_lo[b] > dirty_hi[b]) continue;
+        x1 = dirty_lo[b] > cx1 ? dirty_lo[b] : cx1;
+        x2 = dirty_hi[b] < cx2 ? dirty_hi[b] : cx2;
+        y1 = b * 8 > cy1 ? b * 8 : cy1;
+        y2 = b * 8 + 7 < cy2 ? b * 8 + 7 : cy2;
+        if (x1 <= x2 && y1 <= y2) copy_out(target, x1 + ox, y1 + oy, x2 + ox, y2 + oy);
+        dirty_lo[b] = LCD_WIDTH;
+        dirty_hi[b] = -1;
+    }
+    return spans;
+}
+
+// sends the spans repainted since the last call
+void LCD_UIDisplay() {
+    int b;
+    for (b = 0; b < LCD_BANKS; ++b) {
+        if (painted_lo[b] > painted_hi[b]) continue;
+        LCD_DisplaySpan(b, painted_lo[b], painted_hi[b]);
+        painted_lo[b] = LCD_WIDTH;
+        painted_hi[b] = -1;
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef UI_H
+#define UI_H
+
+#include "lcd.h"
+
+// Retained widget toolkit.
+// Widgets live in a fixed pool and form a tree, positions are relative to the
+// parent. Setters only invalidate the widget they change; LCD_UIRender then
+// repaints the invalid bank row spans and nothing else.
+// The tree is rendered at the origin and in the clip rectangle of the calling thread.
+// Rendering uses the text renderer, so it leaves the text cursor and mode changed.
+
+#define LCD_UI_MAX_WIDGETS 32
+#define LCD_UI_TEXT 24
+
+typedef int LCD_Widget; // index in the pool, -1 if none
+
+typedef enum {
+    LCD_UI_BOX,
+    LCD_UI_LABEL,
+    LCD_UI_PROGRESS,
+    LCD_UI_MENU
+} LCD_WIDGET_TYPE;
+
+void LCD_UIInit();
+LCD_Widget LCD_UIRoot();
+
+LCD_Widget LCD_UIBox(LCD_Widget parent, int x, int y, int w, int h, int border);
+LCD_Widget LCD_UILabel(LCD_Widget parent, int x, int y, int w, int h, const char *text);
+LCD_Widget LCD_UIProgress(LCD_Widget parent, int x, int y, int w, int h, int max);
+LCD_Widget LCD_UIMenu(LCD_Widget parent, int x, int y, int w, int h, const char **items, int count);
+void LCD_UIRemove(LCD_Widget widget);
+
+void LCD_UISetText(LCD_Widget widget, const char *text);
+void LCD_UISetValue(LCD_Widget widget, int value); // progress, or menu selection
+int LCD_UIGetValue(LCD_Widget widget);
+void LCD_UISetVisible(LCD_Widget widget, int visible);
+void LCD_UISetInverted(LCD_Widget widget, int inverted);
+void LCD_UIMove(LCD_Widget widget, int x, int y);
+void LCD_UIInvalidate(LCD_Widget widget);
+
+int LCD_UIRender();
+void LCD_UIDisplay();
+
+#endif